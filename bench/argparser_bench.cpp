@@ -0,0 +1,289 @@
+#include <lib/argparser/ArgParser.hpp>
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+
+using namespace ArgumentParser;
+
+std::vector<std::string> MakeNames(size_t count) {
+    std::vector<std::string> names;
+    names.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        names.push_back("option-" + std::to_string(i * 7919 % 100003));
+    }
+    return names;
+}
+
+char MakeNickname(size_t index) {
+    static const std::string kNicknames = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    return kNicknames[index % kNicknames.size()];
+}
+
+// Flags with nicknames for the first 52 names, int arguments for the rest
+void AddOptions(ArgParser& parser, const std::vector<std::string>& names) {
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (i < 52) {
+            parser.AddFlag(MakeNickname(i), names[i], "Flag number " + std::to_string(i));
+        } else {
+            parser.AddIntArgument(names[i], "Option number " + std::to_string(i)).Default(0);
+        }
+    }
+}
+
+const std::vector<int64_t> kOptionCounts = { 10, 100, 2000 };
+
+
+static void BM_SchemaConstruction(benchmark::State& state) {
+    std::vector<std::string> names = MakeNames(state.range(0));
+    for (auto _ : state) {
+        ArgParser parser("Bench");
+        AddOptions(parser, names);
+        parser.Freeze();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * names.size());
+}
+BENCHMARK(BM_SchemaConstruction)->ArgName("options")->ArgsProduct({ kOptionCounts });
+
+
+static void BM_LongNameLookup(benchmark::State& state) {
+    std::vector<std::string> names = MakeNames(state.range(0));
+    ArgParser parser("Bench");
+    for (const std::string& name : names) {
+        parser.AddIntArgument(name).Default(1);
+    }
+    if (state.range(1)) {
+        parser.Freeze();
+    }
+
+    size_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.GetValue<int>(names[index]));
+        index = index + 1 == names.size() ? 0 : index + 1;
+    }
+}
+BENCHMARK(BM_LongNameLookup)
+    ->ArgNames({ "options", "frozen" })
+    ->ArgsProduct({ kOptionCounts, { 0, 1 } });
+
+
+// style: 0 = "--name=value", 1 = "--name value"
+static void BM_LongOptionParse(benchmark::State& state) {
+    std::vector<std::string> names = MakeNames(state.range(0));
+    ArgParser parser("Bench");
+    AddOptions(parser, names);
+    parser.Freeze();
+
+    std::vector<std::string> argv = { "app" };
+    size_t options = 0;
+    for (size_t i = 0; i < 64; ++i) {
+        const std::string& name = names[52 + i * 31 % (names.size() - 52)];
+        if (state.range(1) == 0) {
+            argv.push_back("--" + name + "=42");
+        } else {
+            argv.push_back("--" + name);
+            argv.push_back("42");
+        }
+        ++options;
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.Parse(argv));
+    }
+    state.SetItemsProcessed(state.iterations() * options);
+}
+BENCHMARK(BM_LongOptionParse)
+    ->ArgNames({ "options", "separate" })
+    ->ArgsProduct({ { 100, 2000 }, { 0, 1 } });
+
+
+// clustered: 0 = "-a -b -c ...", 1 = "-abc..."
+static void BM_ShortOptionParse(benchmark::State& state) {
+    std::vector<std::string> names = MakeNames(state.range(0));
+    ArgParser parser("Bench");
+    AddOptions(parser, names);
+    parser.Freeze();
+
+    std::vector<std::string> argv = { "app" };
+    std::string cluster = "-";
+    for (size_t i = 0; i < 52; ++i) {
+        if (state.range(1)) {
+            cluster += MakeNickname(i);
+        } else {
+            argv.push_back(std::string("-") + MakeNickname(i));
+        }
+    }
+    if (state.range(1)) {
+        argv.push_back(cluster);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.Parse(argv));
+    }
+    state.SetItemsProcessed(state.iterations() * 52);
+}
+BENCHMARK(BM_ShortOptionParse)
+    ->ArgNames({ "options", "clustered" })
+    ->ArgsProduct({ { 100, 2000 }, { 0, 1 } });
+
+
+static void BM_IntConversion(benchmark::State& state) {
+    std::vector<std::string> argv = { "app" };
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        argv.push_back(std::to_string(i * 7919 - 1000000));
+    }
+
+    for (auto _ : state) {
+        ArgParser parser("Bench");
+        parser.AddIntArgument("N").MultiValue().Reserve(argv.size()).Positional();
+        benchmark::DoNotOptimize(parser.Parse(argv));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_IntConversion)->ArgName("tokens")->Arg(1000)->Arg(100000);
+
+
+// delimited: 0 = one --ids token per value, 1 = all values in a single comma separated token
+static void BM_DelimitedIntList(benchmark::State& state) {
+    std::vector<std::string> argv = { "app" };
+    std::string list = "--ids=";
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        std::string value = std::to_string(i * 7919 - 1000000);
+        argv.push_back("--ids=" + value);
+        list += value;
+        list += ',';
+    }
+    list.pop_back();
+    if (state.range(1)) {
+        argv = { "app", list };
+    }
+
+    for (auto _ : state) {
+        ArgParser parser("Bench");
+        parser.AddIntArgument("ids").MultiValue(0, ',');
+        benchmark::DoNotOptimize(parser.Parse(argv));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DelimitedIntList)
+    ->ArgNames({ "values", "delimited" })
+    ->ArgsProduct({ { 1000, 100000 }, { 0, 1 } });
+
+
+static void BM_StringConversion(benchmark::State& state) {
+    std::vector<std::string> argv = { "app" };
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        argv.push_back("/data/input/part-" + std::to_string(i) + ".parquet");
+    }
+
+    for (auto _ : state) {
+        ArgParser parser("Bench");
+        if (state.range(1)) {
+            parser.AddStringViewArgument("files").MultiValue().Reserve(argv.size()).Positional();
+        } else {
+            parser.AddStringArgument("files").MultiValue().Reserve(argv.size()).Positional();
+        }
+        benchmark::DoNotOptimize(parser.Parse(argv));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StringConversion)
+    ->ArgNames({ "tokens", "view" })
+    ->ArgsProduct({ { 1000, 100000 }, { 0, 1 } });
+
+
+static void BM_HugePositionalList(benchmark::State& state) {
+    std::vector<std::string> argv = { "app", "--verbose" };
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        argv.push_back("file-" + std::to_string(i));
+    }
+    std::vector<const char*> raw_argv;
+    for (const std::string& token : argv) {
+        raw_argv.push_back(token.c_str());
+    }
+
+    for (auto _ : state) {
+        ArgParser parser("Bench");
+        parser.AddFlag('v', "verbose");
+        parser.AddStringViewArgument("files").MultiValue(1).Positional();
+        benchmark::DoNotOptimize(parser.Parse(raw_argv));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HugePositionalList)->ArgName("tokens")->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+
+// prepass: 0 = classify each token in the parse loop, 1 = vectorized classification ahead of it
+static void BM_TokenPrepass(benchmark::State& state) {
+    std::vector<std::string_view> argv = { "app" };
+    std::vector<std::string> storage;
+    storage.reserve(state.range(0));
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        storage.push_back("--define=key" + std::to_string(i));
+    }
+    for (const std::string& token : storage) {
+        argv.push_back(token);
+    }
+
+    for (auto _ : state) {
+        ArgParser parser("Bench");
+        parser.AddStringViewArgument("define").MultiValue().Reserve(argv.size());
+        parser.EnableTokenPrepass(state.range(1));
+        benchmark::DoNotOptimize(parser.Parse(argv));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TokenPrepass)
+    ->ArgNames({ "tokens", "prepass" })
+    ->ArgsProduct({ { 1000000 }, { 0, 1 } })
+    ->Unit(benchmark::kMillisecond);
+
+
+// cached: 0 = rendered on every call, 1 = rendered once
+static void BM_HelpDescription(benchmark::State& state) {
+    std::vector<std::string> names = MakeNames(state.range(0));
+    ArgParser parser("Bench");
+    parser.AddHelp('h', "help", "Benchmark program");
+    AddOptions(parser, names);
+
+    for (auto _ : state) {
+        if (state.range(1) == 0) {
+            parser.SetHelpWidth(80);
+        }
+        std::string text = parser.HelpDescription();
+        benchmark::DoNotOptimize(text.data());
+    }
+}
+BENCHMARK(BM_HelpDescription)
+    ->ArgNames({ "options", "cached" })
+    ->ArgsProduct({ kOptionCounts, { 0, 1 } });
+
+
+// access: 0 = GetValue by name, 1 = FindValue by name, 2 = ArgHandle
+static void BM_ValueRead(benchmark::State& state) {
+    std::vector<std::string> names = MakeNames(state.range(0));
+    ArgParser parser("Bench");
+    std::vector<ArgHandle<int>> handles;
+    for (const std::string& name : names) {
+        handles.push_back(parser.AddIntArgument(name).Default(1).Handle());
+    }
+    parser.Parse(std::vector<std::string_view>{ "app" });
+
+    size_t index = 0;
+    for (auto _ : state) {
+        if (state.range(1) == 0) {
+            benchmark::DoNotOptimize(parser.GetValue<int>(names[index]));
+        } else if (state.range(1) == 1) {
+            benchmark::DoNotOptimize(parser.FindValue<int>(names[index]));
+        } else {
+            int value = *handles[index].Value();
+            benchmark::DoNotOptimize(value);
+        }
+        index = index + 1 == names.size() ? 0 : index + 1;
+    }
+}
+BENCHMARK(BM_ValueRead)
+    ->ArgNames({ "options", "access" })
+    ->ArgsProduct({ kOptionCounts, { 0, 1, 2 } });
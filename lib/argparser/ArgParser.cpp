@@ -1,154 +1,832 @@
 #include "ArgParser.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 namespace ArgumentParser {
 
+namespace {
+
+// Appends text word by word, breaking lines at width and indenting continuation lines to column
+void AppendWrapped(std::string& out, std::string_view text, size_t column, size_t width) {
+    size_t line_length = column;
+    bool is_line_empty = true;
+    while (!text.empty()) {
+        size_t word_end = text.find(' ');
+        std::string_view word = text.substr(0, word_end);
+        text.remove_prefix(word_end == std::string_view::npos ? text.size() : word_end + 1);
+        if (word.empty()) {
+            continue;
+        }
+        if (!is_line_empty && line_length + 1 + word.size() > width) {
+            out += '\n';
+            out.append(column, ' ');
+            line_length = column;
+            is_line_empty = true;
+        }
+        if (!is_line_empty) {
+            out += ' ';
+            ++line_length;
+        }
+        out += word;
+        line_length += word.size();
+        is_line_empty = false;
+    }
+    out += '\n';
+}
+
+ParseErrorCode ErrorFor(ParseStatus status) {
+    switch (status) {
+        case ParseStatus::kOutOfRange:
+            return ParseErrorCode::kOutOfRange;
+        case ParseStatus::kUnsupported:
+            return ParseErrorCode::kUnsupported;
+        default:
+            return ParseErrorCode::kInvalidValue;
+    }
+}
+
+} // namespace
+
 ArgParser::~ArgParser() {
-    for (auto ptr : args_data) {
-        delete ptr.second;
+    for (const OwnedArg& owned : owned_args) {
+        owned.deleter(owned.arg, resource);
     }
 }
 
+// Writes parsed values into the arguments themselves
+class ArgParser::ArgumentSink {
+public:
+    ArgumentSink(ArgParser& parser)
+        : parser(parser) {}
+
+    ParseStatus Save(ArgData* arg, std::string_view value) {
+        Touch(arg);
+        ParseStatus status = ParseStatus::kParsedSuccessfully;
+        if (parser.is_conversion_deferred && arg->takes_param && !arg->is_positional && !arg->has_external_storage) {
+            status = arg->Defer(value);
+        } else {
+            status = arg->ParseAndSave(value);
+            ARGPARSER_STAT(
+                ++parser.stats.conversions;
+                parser.stats.failed_conversions += status != ParseStatus::kParsedSuccessfully;
+            )
+        }
+        if (status == ParseStatus::kParsedSuccessfully) {
+            arg->source = ValueSource::kCommandLine;
+        }
+        return status;
+    }
+
+    bool WasParsed(const ArgData* arg) const {
+        return arg->was_parsed;
+    }
+
+    void SetSource(ArgData* arg, ValueSource source) {
+        Touch(arg);
+        arg->source = source;
+    }
+
+    ValueSource GetSource(const ArgData* arg) const {
+        return arg->source;
+    }
+
+    bool IsValid(const ArgData* arg) const {
+        return arg->Validate();
+    }
+
+    bool IsSet(const BoolArg* flag) const {
+        return flag && flag->storage.GetValue();
+    }
+
+    std::pmr::vector<MappedFile>& Files() {
+        return parser.response_files;
+    }
+
+    bool Fail(ParseErrorCode code, size_t index, std::string_view token, const ArgData* arg, const ArgData* suggestion = nullptr) {
+        parser.error = ParseError{ code, index, token, arg, suggestion };
+        return false;
+    }
+
+    ArgParser* SelectSubcommand(std::string_view name) {
+        return parser.SelectSubcommand(name);
+    }
+
+    ParseStats& Stats() {
+        return parser.stats;
+    }
+
+    const TraceHooks& Hooks() const {
+        return parser.trace_hooks;
+    }
+
+    bool ParseSubcommand(ArgParser& command, TokenCursor& cursor) {
+        if (!command.ParseSubcommand(cursor)) {
+            parser.error = command.error;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    void Touch(ArgData* arg) {
+        if (!arg->is_touched) {
+            arg->is_touched = true;
+            parser.touched.push_back(arg);
+        }
+    }
+
+    ArgParser& parser;
+};
+
+// Writes parsed values into the slots of a ParseResult and leaves the arguments untouched
+class ArgParser::ResultSink {
+public:
+    ResultSink(ParseResult& result)
+        : result(result) {}
+
+    ParseStatus Save(ArgData* arg, std::string_view value) {
+        ArgSlot& slot = result.GetOrCreateSlot(arg);
+        ParseStatus status = arg->ParseInto(value, slot);
+        if (status == ParseStatus::kParsedSuccessfully) {
+            slot.source = ValueSource::kCommandLine;
+        }
+        return status;
+    }
+
+    bool WasParsed(const ArgData* arg) const {
+        const ArgSlot* slot = result.GetSlot(arg);
+        return slot && slot->was_parsed;
+    }
+
+    void SetSource(ArgData* arg, ValueSource source) {
+        result.GetOrCreateSlot(arg).source = source;
+    }
+
+    ValueSource GetSource(const ArgData* arg) const {
+        const ArgSlot* slot = result.GetSlot(arg);
+        return slot ? slot->source : ValueSource::kNone;
+    }
+
+    bool IsValid(const ArgData* arg) const {
+        return arg->ValidateSlot(result.GetSlot(arg));
+    }
+
+    bool IsSet(const BoolArg* flag) const {
+        const ArgSlot* slot = flag ? result.GetSlot(flag) : nullptr;
+        return slot && static_cast<const ValueSlot<bool>*>(slot)->storage.GetValue();
+    }
+
+    std::pmr::vector<MappedFile>& Files() {
+        return result.files;
+    }
+
+    bool Fail(ParseErrorCode code, size_t index, std::string_view token, const ArgData* arg, const ArgData* suggestion = nullptr) {
+        result.error = ParseError{ code, index, token, arg, suggestion };
+        return false;
+    }
+
+    // Building a subcommand schema mutates the parser, so a detached parse treats the name as a positional
+    ArgParser* SelectSubcommand(std::string_view) {
+        return nullptr;
+    }
+
+    bool ParseSubcommand(ArgParser&, TokenCursor&) {
+        return false;
+    }
+
+    // Detached parses run concurrently, so their counts are dropped and no hook is called
+    ParseStats& Stats() {
+        return stats;
+    }
+
+    const TraceHooks& Hooks() const {
+        return hooks;
+    }
+
+private:
+    ParseResult& result;
+    ParseStats stats;
+    TraceHooks hooks;
+};
+
 bool ArgParser::Parse(int argc, char** argv) {
-	return Parse(std::vector<std::string_view>(argv, argv + argc));
+    return ParseTokens(std::span<const char* const>(argv, argc));
+}
+
+bool ArgParser::Parse(std::span<const char* const> argv) {
+    return ParseTokens(argv);
 }
 
 bool ArgParser::Parse(const std::vector<std::string>& argv) {
-    return Parse(std::vector<std::string_view>(argv.begin(), argv.end()));
+    return ParseTokens(std::span<const std::string>(argv));
 }
 
 bool ArgParser::Parse(const std::vector<std::string_view>& argv) {
-    FindPositional();
+    return ParseTokens(std::span<const std::string_view>(argv));
+}
+
+ParseResult ArgParser::ParseDetached(int argc, char** argv) const {
+    return ParseDetachedTokens(std::span<const char* const>(argv, argc));
+}
+
+ParseResult ArgParser::ParseDetached(std::span<const char* const> argv) const {
+    return ParseDetachedTokens(argv);
+}
+
+ParseResult ArgParser::ParseDetached(const std::vector<std::string>& argv) const {
+    return ParseDetachedTokens(std::span<const std::string>(argv));
+}
+
+ParseResult ArgParser::ParseDetached(const std::vector<std::string_view>& argv) const {
+    return ParseDetachedTokens(std::span<const std::string_view>(argv));
+}
+
+std::vector<ParseResult> ArgParser::ParseBatch(std::span<const std::vector<std::string>> command_lines, size_t threads,
+                                               WorkerPool* pool) const {
+    std::vector<ParseResult> results(command_lines.size());
+    std::atomic<size_t> next = 0;
+    std::function<void()> worker = [&]() {
+        for (size_t i = next++; i < command_lines.size(); i = next++) {
+            results[i] = ParseDetached(command_lines[i]);
+        }
+    };
+
+    if (!pool) {
+        pool = &WorkerPool::Shared();
+    }
+    if (threads == 0) {
+        threads = pool->Size() + 1;
+    }
+    threads = std::min(threads, command_lines.size());
+    if (threads > 1) {
+        pool->Run(threads - 1, worker);
+    } else {
+        worker();
+    }
+    return results;
+}
+
+bool ArgParser::ParseTokens(const TokenSpan& argv) {
+    error = ParseError();
+    selected_subcommand = std::string_view();
+    if (!is_schema_valid) {
+        error.code = ParseErrorCode::kInvalidSchema;
+        return false;
+    }
+    if (!is_frozen) {
+        Freeze();
+    }
+
+    ArgumentSink sink(*this);
+    return ParseWith(argv, sink);
+}
+
+bool ArgParser::ParseSubcommand(TokenCursor& cursor) {
+    error = ParseError();
+    selected_subcommand = std::string_view();
+    if (!is_schema_valid) {
+        error.code = ParseErrorCode::kInvalidSchema;
+        return false;
+    }
+    if (!is_frozen) {
+        Freeze();
+    }
+
+    ArgumentSink sink(*this);
+    return ParseFrom(cursor, sink);
+}
+
+ParseResult ArgParser::ParseDetachedTokens(const TokenSpan& argv) const {
+    ParseResult result(*this, owned_args.size());
+    if (!is_schema_valid || !is_frozen) {
+        result.error.code = is_schema_valid ? ParseErrorCode::kNotFrozen : ParseErrorCode::kInvalidSchema;
+        return result;
+    }
+
+    ResultSink sink(result);
+    result.is_ok = ParseWith(argv, sink);
+    result.asked_for_help = sink.IsSet(help);
+    return result;
+}
+
+template<typename Sink>
+bool ArgParser::ParseWith(const TokenSpan& argv, Sink& sink) const {
+    TokenCursor cursor(argv);
+    if (response_file_options.has_value()) {
+        cursor.ExpandResponseFiles(response_file_options.value(), sink.Files());
+    }
+    if (is_token_prepass) {
+        cursor.ClassifyAhead();
+    }
+    return ParseFrom(cursor, sink);
+}
+
+template<typename Sink>
+bool ArgParser::ParseFrom(TokenCursor& cursor, Sink& sink) const {
+    ARGPARSER_STAT(std::optional<PhaseTimer> timer(std::in_place, sink.Stats(), sink.Hooks(), ParsePhase::kParse);)
     bool met_splitter = false;
-    for (int iterator = 1; iterator < argv.size(); ++iterator) {
+    size_t positional_cursor = 0;
+    std::string_view token;
+    TokenInfo info;
+    // A response file that fails while an option's value is read is reported as such, not as a missing value
+    auto fail_missing_value = [&](size_t index, std::string_view token, ArgData* arg) {
+        if (cursor.Failed()) {
+            return sink.Fail(ParseErrorCode::kResponseFile, cursor.Index(), cursor.FailedToken(), nullptr);
+        }
+        return sink.Fail(ParseErrorCode::kMissingValue, index, token, arg);
+    };
+    while (cursor.Next(token, info)) {
         bool parsed = false;
+        size_t index = cursor.Index();
+        ARGPARSER_STAT(
+            ++sink.Stats().tokens_by_kind[static_cast<size_t>(info.kind)];
+            if (sink.Hooks().on_token) {
+                sink.Hooks().on_token(index, token, info.kind);
+            }
+        )
 
-        if (argv[iterator] == kSplitter) {
+        if (info.kind == TokenKind::kSplitter) {
             met_splitter = true;
+            cursor.StopExpansion();
             continue;
         }
 
         if (met_splitter) {
-            if (!ParseAsPositional(argv[iterator])) {
+            if (!ParseAsPositional(token, index, positional_cursor, sink)) {
                 return false;
-            } else { 
-                continue;
             }
+            continue;
         }
 
-        if (argv[iterator].starts_with(kLongArgPrefix)) {
-            std::string_view arg_name = argv[iterator].substr(kLongArgPrefix.length());
+        if (info.kind == TokenKind::kLong || info.kind == TokenKind::kLongWithValue) {
+            std::string_view arg_name = token.substr(kLongArgPrefix.length());
             std::string_view arg_value;
-            bool is_valid = true;
-            size_t equal_sign_pos = arg_name.find('=');
-            if (equal_sign_pos == std::string_view::npos) {
-                is_valid = iterator + 1 < argv.size();
-                arg_value = is_valid ? argv[++iterator] : std::string_view();
-            } else {
-                arg_value = arg_name.substr(equal_sign_pos + 1);
-                arg_name = arg_name.substr(0, equal_sign_pos);
-                is_valid = arg_name.size();
+            bool has_value = info.kind == TokenKind::kLongWithValue;
+            if (has_value) {
+                arg_value = token.substr(info.equal_offset + 1);
+                arg_name = token.substr(kLongArgPrefix.length(), info.equal_offset - kLongArgPrefix.length());
             }
 
-            if (ArgData* argdata_ptr = GetArgData(arg_name)) {
-                if (argdata_ptr->takes_param && is_valid && argdata_ptr->ParseAndSave(arg_value) == ParseStatus::kParsedSuccessfully) {
-                    parsed = true;
-                    continue;
+            bool is_ambiguous = false;
+            ArgData* argdata_ptr = arg_name.size() ? MatchLongName(arg_name, is_ambiguous) : nullptr;
+            ARGPARSER_STAT(++sink.Stats().lookups; sink.Stats().lookup_misses += !argdata_ptr;)
+            if (is_ambiguous) {
+                return sink.Fail(ParseErrorCode::kAmbiguousOption, index, token, nullptr);
+            }
+            if (!argdata_ptr) {
+                return sink.Fail(ParseErrorCode::kUnknownOption, index, token, nullptr, SuggestLongName(arg_name));
+            }
+            if (argdata_ptr->takes_param) {
+                if (!has_value) {
+                    if (!cursor.NextValue(arg_value)) {
+                        return fail_missing_value(index, token, argdata_ptr);
+                    }
+                    index = cursor.Index();
                 }
-                if (!argdata_ptr->takes_param && argdata_ptr->ParseAndSave("") == ParseStatus::kParsedSuccessfully) {
-                    parsed = true;
-                    continue;
+                ParseStatus status = sink.Save(argdata_ptr, arg_value);
+                if (status != ParseStatus::kParsedSuccessfully) {
+                    return sink.Fail(ErrorFor(status), index, arg_value, argdata_ptr);
                 }
+            } else if (sink.Save(argdata_ptr, "") != ParseStatus::kParsedSuccessfully) {
+                return sink.Fail(ParseErrorCode::kInvalidValue, index, token, argdata_ptr);
             }
-
-            return false;
-        } else if(argv[iterator].starts_with(kShortArgPrefix)) {
-            for (int i = 1; i < argv[iterator].size(); ++i) {
-                char arg = argv[iterator][i];
+            continue;
+        } else if (info.kind == TokenKind::kShort) {
+            for (size_t i = 1; i < token.size(); ++i) {
                 parsed = false;
 
-                ArgData* argdata = nullptr;
-                for (auto& [name, args_data] : args_data) {
-                    if (args_data->nickname == arg) {
-                        argdata = args_data;
-                        break;
-                    }
-                }
+                ArgData* argdata = GetShortArgData(token[i]);
+                ARGPARSER_STAT(++sink.Stats().lookups; sink.Stats().lookup_misses += !argdata;)
 
                 if (!argdata) {
                     break;
                 } else if (argdata->takes_param) {
-                    if (i + 1 < argv[iterator].size() && argv[iterator][i + 1] != '=') {
-                        return false;
-                    }
-                    if (i + 1 < argv[iterator].size() && argv[iterator][i + 1] == '=') {
-                        std::string_view arg_value = argv[iterator].substr(argv[iterator].find('=') + 1);
-                        if (argdata->ParseAndSave(arg_value) != ParseStatus::kParsedSuccessfully) {
-                            return false;
+                    std::string_view arg_value;
+                    size_t value_index = index;
+                    if (i + 1 < token.size()) {
+                        if (token[i + 1] != '=') {
+                            return sink.Fail(ParseErrorCode::kInvalidValue, index, token, argdata);
                         }
-                    } else if (iterator + 1 >= argv.size() || argdata->ParseAndSave(argv[++iterator]) != ParseStatus::kParsedSuccessfully) {
-                        return false;
+                        arg_value = token.substr(i + 2);
+                    } else if (!cursor.NextValue(arg_value)) {
+                        return fail_missing_value(index, token, argdata);
+                    } else {
+                        value_index = cursor.Index();
+                    }
+                    ParseStatus status = sink.Save(argdata, arg_value);
+                    if (status != ParseStatus::kParsedSuccessfully) {
+                        return sink.Fail(ErrorFor(status), value_index, arg_value, argdata);
                     }
                     parsed = true;
                     break;
-                } else if (argdata->ParseAndSave("") == ParseStatus::kParsedSuccessfully) {
+                } else if (sink.Save(argdata, "") == ParseStatus::kParsedSuccessfully) {
                     parsed = true;
                     continue;
                 }
 
+                return sink.Fail(ParseErrorCode::kInvalidValue, index, token, argdata);
+            }
+        }
+
+        if (parsed) {
+            continue;
+        }
+        // The rest of the command line belongs to the subcommand; parent options stay visible to it
+        if (ArgParser* command = subcommands.empty() ? nullptr : sink.SelectSubcommand(token)) {
+            if (!sink.ParseSubcommand(*command, cursor)) {
                 return false;
             }
-        } 
-        
-        if (!parsed && !ParseAsPositional(argv[iterator])) {
+            if (command->Help()) {
+                return true;
+            }
+            break;
+        }
+        if (!ParseAsPositional(token, index, positional_cursor, sink)) {
             return false;
         }
     }
-    
-    return asked_for_help || IsValid();
+
+    if (cursor.Failed()) {
+        return sink.Fail(ParseErrorCode::kResponseFile, cursor.Index(), cursor.FailedToken(), nullptr);
+    }
+
+    ARGPARSER_STAT(timer.emplace(sink.Stats(), sink.Hooks(), ParsePhase::kValidation);)
+    if (!ResolveFallbacks(sink)) {
+        return false;
+    }
+
+    return sink.IsSet(help) || (parent && sink.IsSet(parent->help)) || IsValid(sink);
 }
 
-bool ArgParser::ParseAsPositional(std::string_view arg) {
-    for (ArgData* argdata_ptr : positional) {
-        if ((!argdata_ptr->was_parsed || argdata_ptr->multivalue_min_count.has_value()) 
-            && argdata_ptr->ParseAndSave(arg) == ParseStatus::kParsedSuccessfully) {
+// Positionals are filled in declaration order: a token goes to the first one from the cursor on that converts
+// it, so an unfilled single-value positional that rejects a token is only skipped for that token ("name 5"
+// still fills an int positional declared before a string one). The cursor only moves forward: it passes a
+// single-value positional once it is filled and closes a multi-value one the first time it rejects a token,
+// so a run of values never resumes after a later positional has taken one.
+template<typename Sink>
+bool ArgParser::ParseAsPositional(std::string_view arg, size_t index, size_t& cursor, Sink& sink) const {
+    ArgData* rejected = nullptr;
+    ParseStatus status = ParseStatus::kNotParsed;
+    for (size_t i = cursor; i < positional.size(); ++i) {
+        ArgData* argdata_ptr = positional[i];
+        bool is_multivalue = argdata_ptr->multivalue_min_count.has_value();
+        bool is_filled = sink.WasParsed(argdata_ptr);
+        if (!is_multivalue && is_filled) {
+            cursor += i == cursor;
+            continue;
+        }
+        ParseStatus current = sink.Save(argdata_ptr, arg);
+        if (current == ParseStatus::kParsedSuccessfully) {
+            cursor += !is_multivalue && i == cursor;
             return true;
         }
+        ARGPARSER_STAT(++sink.Stats().failed_positional_attempts;)
+        if (is_multivalue) {
+            cursor = i + 1;
+        }
+        if (!rejected) {
+            rejected = argdata_ptr;
+            status = current;
+        }
+    }
+
+    if (rejected) {
+        return sink.Fail(ErrorFor(status), index, arg, rejected);
+    }
+    bool is_option = arg.size() > 1 && arg.front() == kShortArgPrefix;
+    return sink.Fail(is_option ? ParseErrorCode::kUnknownOption : ParseErrorCode::kUnexpectedArgument, index, arg, nullptr);
+}
+
+ArgData* ArgParser::FindArgument(std::string_view name) const {
+    return GetArgData(name);
+}
+
+ArgData* ArgParser::GetArgData(std::string_view name) const {
+    ArgData* arg = nullptr;
+    if (is_frozen) {
+        arg = long_args.Find(name);
+    } else if (auto iterator = args_data.find(name); iterator != args_data.end()) {
+        arg = iterator->second;
     }
-    return false;
+    return arg || !parent ? arg : parent->GetArgData(name);
+}
+
+ArgData* ArgParser::GetShortArgData(char nickname) const {
+    ArgData* arg = short_args[static_cast<unsigned char>(nickname)];
+    return arg || !parent ? arg : parent->GetShortArgData(nickname);
 }
 
-ArgData* ArgParser::GetArgData(std::string_view name) {
-    auto iterator = args_data.find(name);
-    if (iterator == args_data.end()) {
+ArgData* ArgParser::MatchLongName(std::string_view name, bool& is_ambiguous) const {
+    is_ambiguous = false;
+    ArgData* arg = GetArgData(name);
+    for (const ArgParser* scope = this; !arg && !is_ambiguous && scope && is_prefix_matching; scope = scope->parent) {
+        arg = scope->long_names.FindPrefix(name, is_ambiguous);
+    }
+    return arg;
+}
+
+ArgData* ArgParser::SuggestLongName(std::string_view name) const {
+    ArgData* arg = nullptr;
+    for (const ArgParser* scope = this; !arg && scope; scope = scope->parent) {
+        arg = scope->long_names.Suggest(name);
+    }
+    return arg;
+}
+
+void ArgParser::AddSubcommand(const std::string& name, SubcommandFactory factory, const std::string& description) {
+    InvalidateHelp();
+    Subcommand command{ std::move(factory), std::pmr::string(description, resource), nullptr };
+    if (!subcommands.try_emplace(std::pmr::string(name, resource), std::move(command)).second) {
+        is_schema_valid = false;
+    }
+}
+
+ArgParser* ArgParser::SelectSubcommand(std::string_view name) {
+    auto iterator = subcommands.find(name);
+    if (iterator == subcommands.end()) {
         return nullptr;
     }
-    return iterator->second;
+    Subcommand& command = iterator->second;
+    if (!command.parser) {
+        command.parser = std::make_unique<ArgParser>(this->name + " " + std::string(iterator->first), resource);
+        command.parser->parent = this;
+        command.parser->is_conversion_deferred = is_conversion_deferred;
+        command.parser->is_prefix_matching = is_prefix_matching;
+        command.factory(*command.parser);
+    }
+    selected_subcommand = iterator->first;
+    return command.parser.get();
 }
 
-void ArgParser::FindPositional() {
-    positional.clear();
-    for (auto& [name, arg_ptr] : args_data) {
-        if (arg_ptr->is_positional) {
-            positional.push_back(arg_ptr);
+ArgParser* ArgParser::GetSubcommand() const {
+    if (selected_subcommand.empty()) {
+        return nullptr;
+    }
+    return subcommands.find(selected_subcommand)->second.parser.get();
+}
+
+std::string_view ArgParser::GetSubcommandName() const {
+    return selected_subcommand;
+}
+
+void ArgParser::RegisterNickname(ArgData* arg, char nickname) {
+    InvalidateHelp();
+    ArgData*& slot = short_args[static_cast<unsigned char>(nickname)];
+    if (slot && slot != arg) {
+        is_schema_valid = false;
+        return;
+    }
+    if (arg->nickname.has_value() && GetShortArgData(arg->nickname.value()) == arg) {
+        short_args[static_cast<unsigned char>(arg->nickname.value())] = nullptr;
+    }
+    slot = arg;
+}
+
+void ArgParser::RegisterPositional(ArgData* arg) {
+    auto by_declaration = [](const ArgData* lhs, const ArgData* rhs) {
+        return lhs->index < rhs->index;
+    };
+    positional.insert(std::upper_bound(positional.begin(), positional.end(), arg, by_declaration), arg);
+}
+
+void ArgParser::UpdateRequired(ArgData* arg) {
+    InvalidateHelp();
+    auto iterator = std::find(required.begin(), required.end(), arg);
+    if (arg->IsRequired() && iterator == required.end()) {
+        required.push_back(arg);
+    } else if (!arg->IsRequired() && iterator != required.end()) {
+        required.erase(iterator);
+    }
+}
+
+void ArgParser::RegisterEnv(ArgData* arg) {
+    InvalidateHelp();
+    if (std::find(env_args.begin(), env_args.end(), arg) == env_args.end()) {
+        env_args.push_back(arg);
+    }
+}
+
+template<typename Sink>
+bool ArgParser::ResolveFallbacks(Sink& sink) const {
+    auto has_value = [&sink](const ArgData* arg) {
+        ValueSource source = sink.GetSource(arg);
+        return source == ValueSource::kCommandLine || source == ValueSource::kEnvironment;
+    };
+
+    for (ArgData* arg : env_args) {
+        if (has_value(arg)) {
+            continue;
+        }
+        if (const char* value = std::getenv(arg->env_variable.c_str())) {
+            if (!ParseFallback(arg, value, sink)) {
+                return false;
+            }
+            sink.SetSource(arg, ValueSource::kEnvironment);
+        }
+    }
+
+    if (config_path.empty()) {
+        return true;
+    }
+    // Only arguments still missing a value look up their key; the file is loaded on the first of them
+    const ConfigFile* config = nullptr;
+    for (const auto& [name, arg] : args_data) {
+        if (has_value(arg)) {
+            continue;
         }
+        if (!config && !(config = LoadConfig())) {
+            return sink.Fail(ParseErrorCode::kConfigFile, ParseError::kNoToken, config_path, nullptr);
+        }
+        std::span<const ConfigFile::Entry> entries = config->Find(name);
+        if (entries.empty()) {
+            continue;
+        }
+        for (const ConfigFile::Entry& entry : entries) {
+            if (!ParseFallback(arg, entry.second, sink)) {
+                return false;
+            }
+        }
+        sink.SetSource(arg, ValueSource::kConfigFile);
     }
+    return true;
 }
 
-bool ArgParser::IsValid() const {
-    for (auto& [name, arg] : args_data) {
-        if (!arg->Validate()) {
-            return false;
+template<typename Sink>
+bool ArgParser::ParseFallback(ArgData* arg, std::string_view value, Sink& sink) const {
+    ParseStatus status = ParseStatus::kNotParsed;
+    if (arg->takes_param) {
+        status = sink.Save(arg, value);
+    } else if (value == "1" || value == "true" || value == "yes" || value == "on") {
+        status = sink.Save(arg, "");
+    } else if (value == "0" || value == "false" || value == "no" || value == "off") {
+        return true;
+    }
+    return status == ParseStatus::kParsedSuccessfully || sink.Fail(ErrorFor(status), ParseError::kNoToken, value, arg);
+}
+
+const ConfigFile* ArgParser::LoadConfig() const {
+    std::lock_guard<std::mutex> lock(config_mutex);
+    if (!is_config_loaded) {
+        is_config_valid = config_file.Load(config_path);
+        is_config_loaded = true;
+    }
+    return is_config_valid ? &config_file : nullptr;
+}
+
+template<typename Sink>
+bool ArgParser::IsValid(Sink& sink) const {
+    for (ArgData* arg : required) {
+        if (!sink.IsValid(arg)) {
+            return sink.Fail(ParseErrorCode::kMissingRequired, ParseError::kNoToken, std::string_view(), arg);
         }
     }
     return true;
 }
 
-ArgParser::ArgParser(std::string_view name) {
+ArgParser::ArgParser(std::string_view name)
+    : ArgParser(name, nullptr) {}
+
+ArgParser::ArgParser(std::string_view name, std::pmr::memory_resource* resource)
+    : counting(resource ? resource : &arena)
+    , resource(kStatsEnabled ? &counting : counting.Upstream())
+    , owned_args(this->resource)
+    , args_data(this->resource)
+    , long_args(this->resource)
+    , long_names(this->resource)
+    , positional(this->resource)
+    , required(this->resource)
+    , env_args(this->resource)
+    , touched(this->resource)
+    , subcommands(this->resource)
+    , response_files(this->resource)
+    , config_file(this->resource) {
     this->name = name;
 }
 
 void ArgParser::PushArgument(ArgData* arg_ptr) {
-    args_data[arg_ptr->fullname] = arg_ptr;
+    AdoptArgument(arg_ptr, [](ArgData* arg_ptr, std::pmr::memory_resource*) {
+        delete arg_ptr;
+    });
+}
+
+void ArgParser::AdoptArgument(ArgData* arg_ptr, ArgDeleter deleter) {
+    ARGPARSER_STAT(PhaseTimer timer(stats, trace_hooks, ParsePhase::kRegistration);)
+    InvalidateHelp();
+    arg_ptr->index = owned_args.size();
+    owned_args.push_back(OwnedArg{ arg_ptr, deleter });
+    is_frozen = false;
+    if (!args_data.try_emplace(arg_ptr->fullname, arg_ptr).second) {
+        is_schema_valid = false;
+        return;
+    }
+    arg_ptr->registry = this;
+    if (arg_ptr->nickname.has_value()) {
+        RegisterNickname(arg_ptr, arg_ptr->nickname.value());
+    }
+    if (arg_ptr->is_positional) {
+        RegisterPositional(arg_ptr);
+    }
+    if (!arg_ptr->env_variable.empty()) {
+        RegisterEnv(arg_ptr);
+    }
+    UpdateRequired(arg_ptr);
+}
+
+ParseStats ArgParser::GetStats() const {
+    ParseStats copy = stats;
+    copy.bytes_allocated = counting.Allocated();
+    return copy;
+}
+
+void ArgParser::ResetStats() {
+    stats = ParseStats();
+    counting.ResetCount();
+}
+
+void ArgParser::SetTraceHooks(TraceHooks hooks) {
+    trace_hooks = std::move(hooks);
+}
+
+void ArgParser::EnableTokenPrepass(bool enabled) {
+    is_token_prepass = enabled;
+}
+
+void ArgParser::AllowPrefixMatching(bool enabled) {
+    is_prefix_matching = enabled;
+}
+
+void ArgParser::AllowResponseFiles(const ResponseFileOptions& options) {
+    response_file_options = options;
+}
+
+void ArgParser::SetConfigFile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(config_mutex);
+    config_path = path;
+    is_config_loaded = false;
+}
+
+const ParseError& ArgParser::GetError() const {
+    return error;
+}
+
+ValueSource ArgParser::GetSource(std::string_view name) const {
+    ArgData* arg = GetArgData(name);
+    return arg ? arg->source : ValueSource::kNone;
+}
+
+void ArgParser::Freeze() {
+    ARGPARSER_STAT(PhaseTimer timer(stats, trace_hooks, ParsePhase::kRegistration);)
+    std::vector<std::pair<std::string_view, ArgData*>> names;
+    names.reserve(args_data.size());
+    for (const auto& [name, arg_ptr] : args_data) {
+        names.emplace_back(name, arg_ptr);
+    }
+    long_args.Build(names);
+    long_names.Build(names);
+    is_frozen = true;
+}
+
+void ArgParser::DeferConversion(bool enabled) {
+    is_conversion_deferred = enabled;
+}
+
+bool ArgParser::ValidateAll() {
+    ARGPARSER_STAT(PhaseTimer timer(stats, trace_hooks, ParsePhase::kValidation);)
+    for (ArgData* arg : touched) {
+        if (ParseStatus status = arg->ConvertPending(); status != ParseStatus::kParsedSuccessfully) {
+            error = ParseError{ ErrorFor(status), ParseError::kNoToken, arg->pending_tokens.front(), arg };
+            return false;
+        }
+    }
+    ArgParser* command = GetSubcommand();
+    if (command && !command->ValidateAll()) {
+        error = command->error;
+        return false;
+    }
+    return true;
+}
+
+void ArgParser::Reset() {
+    for (ArgData* arg : touched) {
+        arg->Reset();
+        arg->is_touched = false;
+    }
+    touched.clear();
+    response_files.clear();
+    error = ParseError();
+    if (ArgParser* command = GetSubcommand()) {
+        command->Reset();
+    }
+    selected_subcommand = std::string_view();
 }
 
 // Built-in types
@@ -168,6 +846,14 @@ Argument<std::string>& ArgParser::AddStringArgument(char nickname, const std::st
     return AddStringArgument(fullname, description).AddNickname(nickname); 
 }
 
+Argument<std::string_view>& ArgParser::AddStringViewArgument(const std::string& fullname, const std::string& description) {
+    return AddArgument<StringViewArg>(fullname, true, description); 
+}
+
+Argument<std::string_view>& ArgParser::AddStringViewArgument(char nickname, const std::string& fullname, const std::string& description) {
+    return AddStringViewArgument(fullname, description).AddNickname(nickname); 
+}
+
 Argument<bool>& ArgParser::AddFlag(const std::string& fullname, const std::string& description) {
     return AddArgument<BoolArg>(fullname, false, description).Default(false); 
 }
@@ -177,49 +863,139 @@ Argument<bool>& ArgParser::AddFlag(char nickname, const std::string& fullname, c
 }
 
 void ArgParser::AddHelp(char nickname, const std::string& fullname, const std::string& description) { 
-    AddFlag(nickname, fullname, description).StoreValue(asked_for_help);
+    Argument<bool>& arg = AddFlag(nickname, fullname, description).StoreValue(asked_for_help);
+    help = static_cast<BoolArg*>(&arg);
+    InvalidateHelp();
 }
 
 bool ArgParser::Help() const {
+    if (ArgParser* command = GetSubcommand()) {
+        return asked_for_help || command->Help();
+    }
     return asked_for_help;
 }
 
 std::string ArgParser::HelpDescription() const {
+    std::lock_guard<std::mutex> lock(help_mutex);
+    return RenderedHelp();
+}
 
-    std::stringstream help_description;
-    help_description << name << std::endl;
-    if (help) {
-        help_description << help->description << std::endl;
+const std::string& ArgParser::RenderedHelp() const {
+    if (!is_help_rendered) {
+        RenderHelp();
+        is_help_rendered = true;
+    }
+    return help_text;
+}
+
+void ArgParser::SetHelpWidth(size_t width) {
+    help_width = width;
+    InvalidateHelp();
+}
+
+bool ArgParser::WriteHelp(std::FILE* stream) const {
+    std::lock_guard<std::mutex> lock(help_mutex);
+    const std::string& text = RenderedHelp();
+    return std::fwrite(text.data(), 1, text.size(), stream) == text.size() && std::fflush(stream) == 0;
+}
+
+bool ArgParser::WriteHelp(int fd) const {
+    std::lock_guard<std::mutex> lock(help_mutex);
+    std::string_view text = RenderedHelp();
+    while (!text.empty()) {
+#if defined(_WIN32)
+        int written = _write(fd, text.data(), static_cast<unsigned int>(text.size()));
+#else
+        ssize_t written = write(fd, text.data(), text.size());
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (written <= 0) {
+            return false;
+        }
+        text.remove_prefix(written);
     }
-    help_description << std::endl;
+    return true;
+}
 
-    for (const auto& [name, argdata] : args_data) {
-        if (argdata->nickname.has_value()) {
-            help_description << kShortArgPrefix << argdata->nickname.value() << ',';
-        } else { 
-            help_description << ' ' << ' ' << ' ';
+void ArgParser::InvalidateHelp() {
+    std::lock_guard<std::mutex> lock(help_mutex);
+    is_help_rendered = false;
+}
+
+void ArgParser::RenderHelp() const {
+    ARGPARSER_STAT(PhaseTimer timer(stats, trace_hooks, ParsePhase::kHelp);)
+    auto usage = [this](const ArgData* arg) {
+        std::string column;
+        if (arg->nickname.has_value()) {
+            column += kShortArgPrefix;
+            column += arg->nickname.value();
+            column += ',';
+        } else {
+            column += "   ";
         }
-        help_description << ' ' << ' ';
-        help_description << kLongArgPrefix << argdata->fullname;
-        if (argdata->GetTypename() != "") {
-            help_description << "=<" << argdata->GetTypename() << ">";
+        column += "  ";
+        column += kLongArgPrefix;
+        column += arg->fullname;
+        if (!arg->GetTypename().empty()) {
+            column += "=<";
+            column += arg->GetTypename();
+            column += '>';
         }
-        help_description << ",  ";
-        help_description << argdata->description << ' ';
-        help_description << argdata->Info();
-        help_description << std::endl;
+        return column;
+    };
+
+    size_t width = help_width ? help_width : std::numeric_limits<size_t>::max();
+    size_t column = 0;
+    for (const auto& [name, arg] : args_data) {
+        column = std::max(column, usage(arg).size() + 2);
+    }
+    for (const auto& [name, command] : subcommands) {
+        column = std::max(column, name.size() + 4);
     }
+    column = std::min(column, width / 2);
+
+    help_text.clear();
+    auto append_row = [&](std::string_view left, std::string_view text) {
+        help_text += left;
+        if (left.size() + 2 > column) {
+            help_text += '\n';
+            help_text.append(column, ' ');
+        } else {
+            help_text.append(column - left.size(), ' ');
+        }
+        AppendWrapped(help_text, text, column, width);
+    };
 
-    help_description << std::endl;
+    help_text += name;
+    help_text += '\n';
     if (help) {
-        help_description << kShortArgPrefix << help->nickname.value() << ',';
-        help_description << ' ' << ' ';
-        help_description << kLongArgPrefix << help->fullname << ',' << ' ' << ' ';
-        help_description << "Display this help and exit";
-        help_description << std::endl;
+        help_text += help->description;
+        help_text += '\n';
+    }
+    help_text += '\n';
+
+    for (const auto& [name, arg] : args_data) {
+        if (arg != help) {
+            std::string text(arg->description);
+            text += ' ';
+            text += arg->Info();
+            append_row(usage(arg), text);
+        }
+    }
+
+    if (!subcommands.empty()) {
+        help_text += "\nCommands:\n";
+        for (const auto& [name, command] : subcommands) {
+            append_row("  " + std::string(name), command.description);
+        }
     }
 
-    return help_description.str();
+    if (help) {
+        help_text += '\n';
+        append_row(usage(help), "Display this help and exit");
+    }
 }
 
 } // namespace ArgumentParser
@@ -2,13 +2,34 @@
 
 #include "ArgumentData.hpp"
 #include "BoolArgument.hpp"
+#include "ConfigFile.hpp"
+#include "EnumArgument.hpp"
 #include "IntArgument.hpp"
+#include "NameIndex.hpp"
+#include "NameTrie.hpp"
+#include "NumericArgument.hpp"
+#include "ParseError.hpp"
+#include "ParseResult.hpp"
+#include "ParseStats.hpp"
+#include "StaticParser.hpp"
 #include "StringArgument.hpp"
+#include "StringViewArgument.hpp"
+#include "TokenCursor.hpp"
+#include "TokenSpan.hpp"
+#include "WorkerPool.hpp"
 
+#include <array>
 #include <concepts>
+#include <cstdio>
+#include <functional>
+#include <limits>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -26,36 +47,124 @@ concept IsArgument = requires
     std::is_base_of_v<Argument<typename ArgT::ValueType>, ArgT>;
 };
 
-class ArgParser {
+// True when ArgT still exposes the Convert/ParseAndSave of Argument<T>. An override, even a private one,
+// changes the member pointer type or hides it from this check.
+template <typename ArgT>
+concept InheritsConvert = requires { &ArgT::Convert; } &&
+    std::is_same_v<decltype(&ArgT::Convert), decltype(&Argument<typename ArgT::ValueType>::Convert)>;
+
+template <typename ArgT>
+concept InheritsParseAndSave = requires { &ArgT::ParseAndSave; } &&
+    std::is_same_v<decltype(&ArgT::ParseAndSave), decltype(&Argument<typename ArgT::ValueType>::ParseAndSave)>;
+
+// An argument must override Convert or ParseAndSave: the defaults of Argument<T> cannot parse anything
+template <typename ArgT>
+concept OverridesConversion = IsArgument<ArgT> && !(InheritsConvert<ArgT> && InheritsParseAndSave<ArgT>);
+
+class ArgParser : private ArgRegistry, private ArgLookup {
 public:
     ArgParser(std::string_view id);
+    ArgParser(std::string_view id, std::pmr::memory_resource* resource);
     ArgParser(const ArgParser& other) = delete;
     ArgParser& operator=(const ArgParser& other) = delete;
     ~ArgParser();
 
     bool Parse(int argc, char** argv);
+    bool Parse(std::span<const char* const> argv);
     bool Parse(const std::vector<std::string>& argv);
     bool Parse(const std::vector<std::string_view>& argv);
 
-    template<typename ArgT> requires IsArgument<ArgT>
+    // Parse without touching the arguments: values go to the returned ParseResult, so a frozen
+    // parser can serve any number of threads at once. Requires Freeze() after the last registration.
+    // Custom arguments must override Argument<T>::Convert; one that only overrides ParseAndSave fails
+    // the parse with ParseErrorCode::kUnsupported.
+    ParseResult ParseDetached(int argc, char** argv) const;
+    ParseResult ParseDetached(std::span<const char* const> argv) const;
+    ParseResult ParseDetached(const std::vector<std::string>& argv) const;
+    ParseResult ParseDetached(const std::vector<std::string_view>& argv) const;
+    // Spreads the command lines over at most `threads` threads (0: as many as the pool has, plus the caller).
+    // The threads come from `pool`, or from WorkerPool::Shared(), and are never created per call.
+    std::vector<ParseResult> ParseBatch(std::span<const std::vector<std::string>> command_lines, size_t threads = 0,
+                                        WorkerPool* pool = nullptr) const;
+
+    template<typename ArgT> requires OverridesConversion<ArgT>
     Argument<typename ArgT::ValueType>& AddArgument(const std::string& fullname, bool take_param, const std::string& description = "") {
-        ArgT* arg = new ArgT; 
+        std::pmr::polymorphic_allocator<ArgT> allocator(resource);
+        ArgT* arg = allocator.allocate(1);
+        if constexpr (std::is_constructible_v<ArgT, std::pmr::memory_resource*>) {
+            std::construct_at(arg, resource);
+        } else {
+            std::construct_at(arg);
+        }
         arg->Initialize(fullname, description, take_param);
-        PushArgument(arg);
+        AdoptArgument(arg, [](ArgData* arg_ptr, std::pmr::memory_resource* resource) {
+            std::pmr::polymorphic_allocator<ArgT>(resource).delete_object(static_cast<ArgT*>(arg_ptr));
+        });
         return *arg;
     }
 
-    template<typename ArgT> requires IsArgument<ArgT>
+    template<typename ArgT> requires OverridesConversion<ArgT>
     Argument<typename ArgT::ValueType>& AddArgument(char nickname, const std::string& fullname, bool take_param, const std::string& description = "") {
-        return AddArgument<ArgT>(fullname, description, take_param).AddNickname(nickname);
+        return AddArgument<ArgT>(fullname, take_param, description).AddNickname(nickname);
     }
 
     void PushArgument(ArgData* arg_ptr);
+    void Freeze();
+
+    // The first positional token naming a subcommand hands the rest of the command line to that subcommand's
+    // parser. The factory fills its schema the first time it is selected; options of this parser stay
+    // visible to it. Subcommands are only entered by Parse, not by ParseDetached.
+    using SubcommandFactory = std::function<void(ArgParser&)>;
+    void AddSubcommand(const std::string& name, SubcommandFactory factory, const std::string& description = "");
+    ArgParser* GetSubcommand() const;
+    std::string_view GetSubcommandName() const;
+
+    // Option values are kept as raw tokens by Parse and converted on first read, so a bad value surfaces
+    // as an empty GetValue instead of a failed Parse. The command line must outlive the reads.
+    // Positional arguments and arguments bound with StoreValue/StoreValues still convert during Parse.
+    void DeferConversion(bool enabled = true);
+    // Converts every deferred value now; on failure GetError() names the offending token
+    bool ValidateAll();
+
+    // Restores the state before the first Parse: only the arguments the previous parses touched are reset
+    void Reset();
+
+    // Classifies argv tokens in vectorized blocks ahead of the parse loop; pays off on very long command lines
+    void EnableTokenPrepass(bool enabled = true);
+
+    // Counters and phase timings of this parser; all zero unless built with ARGPARSER_STATS.
+    // ParseDetached is not counted.
+    ParseStats GetStats() const;
+    void ResetStats();
+    void SetTraceHooks(TraceHooks hooks);
+
+    // Accepts an unambiguous prefix of a long name, e.g. --verb for --verbose
+    void AllowPrefixMatching(bool enabled = true);
+
+    // Expands @path tokens into the tokens of the file at path. Values parsed from a response file
+    // (e.g. by StringViewArg) point into its mapping, which is kept until the parser is destroyed.
+    void AllowResponseFiles(const ResponseFileOptions& options = ResponseFileOptions());
+
+    // Arguments missing from the command line are looked up in their Env() variable, then under their
+    // full name in this "key = value" file, which takes precedence over Default. The file is mapped once
+    // and only when some argument got no value from the command line or the environment; a later call
+    // keeps the earlier mapping alive, so string_view values read from it stay valid.
+    void SetConfigFile(const std::string& path);
+    ValueSource GetSource(std::string_view name) const;
+
+    // Why the last Parse failed; empty after a successful one
+    const ParseError& GetError() const;
+
+    template<typename T>
+    ArgHandle<T> GetHandle(std::string_view name) const {
+        Argument<T>* p_arg = GetArgument<T>(name);
+        return p_arg ? p_arg->Handle() : ArgHandle<T>();
+    }
 
     template<typename T>
     std::optional<T> GetValue(std::string_view name) {
         Argument<T>* p_arg = GetArgument<T>(name);
-        if (!p_arg || p_arg->multivalue_min_count.has_value()) {
+        if (!p_arg || p_arg->multivalue_min_count.has_value() || !p_arg->Materialize()) {
             return std::nullopt;
         }
         return p_arg->storage.GetValue();
@@ -64,49 +173,188 @@ public:
     template<typename T>
     std::optional<std::vector<T>> GetValues(std::string_view name) {
         Argument<T>* p_arg = GetArgument<T>(name);
-        if (!p_arg || !p_arg->multivalue_min_count.has_value()) {
+        if (!p_arg || !p_arg->multivalue_min_count.has_value() || !p_arg->Materialize()) {
             return std::nullopt;
         }
         return p_arg->storage.GetValues();
     }
 
+    template<typename T>
+    const T* FindValue(std::string_view name) {
+        Argument<T>* p_arg = GetArgument<T>(name);
+        if (!p_arg || p_arg->multivalue_min_count.has_value() || !p_arg->Materialize()) {
+            return nullptr;
+        }
+        return &p_arg->storage.GetValue();
+    }
+
+    template<typename T>
+    std::optional<std::span<const T>> ViewValues(std::string_view name) {
+        Argument<T>* p_arg = GetArgument<T>(name);
+        if (!p_arg || !p_arg->multivalue_min_count.has_value() || !p_arg->Materialize()) {
+            return std::nullopt;
+        }
+        return std::span<const T>(p_arg->storage.GetValues());
+    }
+
+    template<typename T>
+    std::optional<std::vector<T>> TakeValues(std::string_view name) {
+        Argument<T>* p_arg = GetArgument<T>(name);
+        if (!p_arg || !p_arg->multivalue_min_count.has_value() || !p_arg->Materialize()) {
+            return std::nullopt;
+        }
+        return p_arg->storage.TakeValues();
+    }
+
     // Built-in types
+    template<typename T> requires IsNumeric<T>
+    NumericArg<T>& AddNumericArgument(const std::string& fullname, const std::string& description = "") {
+        return static_cast<NumericArg<T>&>(AddArgument<NumericArg<T>>(fullname, true, description));
+    }
+
+    template<typename T> requires IsNumeric<T>
+    NumericArg<T>& AddNumericArgument(char nickname, const std::string& fullname, const std::string& description = "") {
+        NumericArg<T>& arg = AddNumericArgument<T>(fullname, description);
+        arg.AddNickname(nickname);
+        return arg;
+    }
+
+    template<typename E> requires IsRegisteredEnum<E>
+    EnumArg<E>& AddEnumArgument(const std::string& fullname, const std::string& description = "") {
+        return static_cast<EnumArg<E>&>(AddArgument<EnumArg<E>>(fullname, true, description));
+    }
+
+    template<typename E> requires IsRegisteredEnum<E>
+    EnumArg<E>& AddEnumArgument(char nickname, const std::string& fullname, const std::string& description = "") {
+        EnumArg<E>& arg = AddEnumArgument<E>(fullname, description);
+        arg.AddNickname(nickname);
+        return arg;
+    }
+
     Argument<int>& AddIntArgument(const std::string& fullname, const std::string& description = "");
     Argument<int>& AddIntArgument(char nickname, const std::string& fullname, const std::string& description = "");
     Argument<std::string>& AddStringArgument(const std::string& fullname, const std::string& description = "");
     Argument<std::string>& AddStringArgument(char nickname, const std::string& fullname, const std::string& description = "");
+    Argument<std::string_view>& AddStringViewArgument(const std::string& fullname, const std::string& description = "");
+    Argument<std::string_view>& AddStringViewArgument(char nickname, const std::string& fullname, const std::string& description = "");
     Argument<bool>& AddFlag(const std::string& fullname, const std::string& description = "");
     Argument<bool>& AddFlag(char nickname, const std::string& fullname, const std::string& description = "");
     void AddHelp(char nickname, const std::string& fullname, const std::string& description = "");
+    // Rendered once and cached until the next registration change; descriptions are wrapped to the width
+    // set by SetHelpWidth (0 disables wrapping). Returns a copy, so it may be called from several threads.
     std::string HelpDescription() const;
+    void SetHelpWidth(size_t width);
+    bool WriteHelp(std::FILE* stream) const;
+    bool WriteHelp(int fd) const;
     bool Help() const;
 
 private:
 
-    void FindPositional();
-    bool IsValid() const;
-    bool ParseAsPositional(std::string_view arg);
-    ArgData* GetArgData(std::string_view name);
+    class ArgumentSink;
+    class ResultSink;
+
+    using ArgDeleter = void (*)(ArgData*, std::pmr::memory_resource*);
+
+    struct OwnedArg {
+        ArgData* arg;
+        ArgDeleter deleter;
+    };
+
+    struct Subcommand {
+        SubcommandFactory factory;
+        std::pmr::string description;
+        std::unique_ptr<ArgParser> parser;
+    };
+
+    void AdoptArgument(ArgData* arg_ptr, ArgDeleter deleter);
+    bool ParseTokens(const TokenSpan& argv);
+    bool ParseSubcommand(TokenCursor& cursor);
+    ArgParser* SelectSubcommand(std::string_view name);
+    ParseResult ParseDetachedTokens(const TokenSpan& argv) const;
+    template<typename Sink>
+    bool ParseWith(const TokenSpan& argv, Sink& sink) const;
+    template<typename Sink>
+    bool ParseFrom(TokenCursor& cursor, Sink& sink) const;
+    template<typename Sink>
+    bool ParseAsPositional(std::string_view arg, size_t index, size_t& cursor, Sink& sink) const;
+    template<typename Sink>
+    bool ResolveFallbacks(Sink& sink) const;
+    template<typename Sink>
+    bool ParseFallback(ArgData* arg, std::string_view value, Sink& sink) const;
+    template<typename Sink>
+    bool IsValid(Sink& sink) const;
+    const ConfigFile* LoadConfig() const;
+    void InvalidateHelp() override;
+    void RenderHelp() const;
+    // The cached help text, rendered first if needed; help_mutex must be held
+    const std::string& RenderedHelp() const;
+    ArgData* FindArgument(std::string_view name) const override;
+    void RegisterNickname(ArgData* arg, char nickname) override;
+    void RegisterPositional(ArgData* arg) override;
+    void UpdateRequired(ArgData* arg) override;
+    void RegisterEnv(ArgData* arg) override;
+    ArgData* GetShortArgData(char nickname) const;
+    ArgData* MatchLongName(std::string_view name, bool& is_ambiguous) const;
+    ArgData* SuggestLongName(std::string_view name) const;
+    ArgData* GetArgData(std::string_view name) const;
     template<typename T>
-    Argument<T>* GetArgument(std::string_view name) {
-        auto iterator = args_data.find(name);
-        if (iterator == args_data.end()) {
+    Argument<T>* GetArgument(std::string_view name) const {
+        ArgData* p_arg = GetArgData(name);
+        if (!p_arg || p_arg->value_type != TypeTagOf<T>()) {
             return nullptr;
         }
-        Argument<T>* p_arg = dynamic_cast<Argument<T>*>(args_data.find(name)->second);
-        return p_arg;
+        return static_cast<Argument<T>*>(p_arg);
     }
 
     const char kShortArgPrefix = '-';
     const std::string kLongArgPrefix = "--";
     const std::string kSplitter = "--";
 
+    std::pmr::monotonic_buffer_resource arena;
+    CountingResource counting;
+    std::pmr::memory_resource* resource;
+
     std::string name = "";
     bool asked_for_help = false;
     BoolArg* help = nullptr;
+    ParseError error;
+
+    bool is_schema_valid = true;
+    bool is_frozen = false;
+    bool is_conversion_deferred = false;
+    bool is_prefix_matching = false;
+    bool is_token_prepass = false;
+
+    std::pmr::vector<OwnedArg> owned_args;
+    std::pmr::map<std::string_view, ArgData*, std::less<>> args_data;
+    std::array<ArgData*, std::numeric_limits<unsigned char>::max() + 1> short_args{};
+    NameIndex long_args;
+    NameTrie long_names;
+    std::pmr::vector<ArgData*> positional;
+    std::pmr::vector<ArgData*> required;
+    std::pmr::vector<ArgData*> env_args;
+    std::pmr::vector<ArgData*> touched;
+
+    ArgParser* parent = nullptr;
+    std::pmr::map<std::pmr::string, Subcommand, std::less<>> subcommands;
+    std::string_view selected_subcommand;
+
+    std::optional<ResponseFileOptions> response_file_options;
+    std::pmr::vector<MappedFile> response_files;
+
+    std::string config_path;
+    mutable std::mutex config_mutex;
+    mutable ConfigFile config_file;
+    mutable bool is_config_loaded = false;
+    mutable bool is_config_valid = false;
+
+    mutable ParseStats stats;
+    TraceHooks trace_hooks;
 
-    std::map<std::string, ArgData*, std::less<>> args_data;
-    std::vector<ArgData*> positional;
+    size_t help_width = 80;
+    mutable std::mutex help_mutex;
+    mutable std::string help_text;
+    mutable bool is_help_rendered = false;
 };
 
 } // namespace ArgumentParser
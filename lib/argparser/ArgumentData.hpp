@@ -1,9 +1,14 @@
 #pragma once
 
+#include "Delimiters.hpp"
+
+#include <algorithm>
 #include <charconv>
+#include <memory>
+#include <memory_resource>
 #include <optional>
 #include <string>
-#include <sstream>
+#include <type_traits>
 #include <typeinfo>
 #include <vector>
 
@@ -12,28 +17,128 @@ namespace ArgumentData {
 enum class ParseStatus {
     kParsedSuccessfully,
     kNotParsed,
-    kInvalidArguments
+    kInvalidArguments,
+    kOutOfRange,
+    kUnsupported
+};
+
+enum class ValueSource {
+    kNone,
+    kDefault,
+    kCommandLine,
+    kEnvironment,
+    kConfigFile
+};
+
+using TypeTag = const void*;
+
+template<typename T>
+struct TypeTagHolder {
+    static constexpr char tag = 0;
+};
+
+// Identifies a value type without RTTI: every T gets its own static address
+template<typename T>
+constexpr TypeTag TypeTagOf() {
+    return &TypeTagHolder<T>::tag;
+}
+
+class ArgData;
+
+// Per-parse state of one argument, kept outside the argument so a frozen schema can be parsed concurrently
+class ArgSlot {
+public:
+    virtual ~ArgSlot() = default;
+
+    bool was_parsed = false;
+    ValueSource source = ValueSource::kNone;
+};
+
+class ArgRegistry {
+public:
+    virtual ~ArgRegistry() = default;
+
+    virtual void RegisterNickname(ArgData* arg, char nickname) = 0;
+    virtual void RegisterPositional(ArgData* arg) = 0;
+    virtual void UpdateRequired(ArgData* arg) = 0;
+    virtual void RegisterEnv(ArgData* arg) = 0;
+    virtual void InvalidateHelp() = 0;
 };
 
 class ArgData {
 public:
+    ArgData(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : fullname(resource), description(resource), env_variable(resource), pending_tokens(resource) {}
+
     virtual ~ArgData() = default;
 
+    ArgRegistry* registry = nullptr;
+    TypeTag value_type = nullptr;
+    size_t index = 0;
+
     std::optional<char> nickname = std::nullopt;
-    std::string fullname;
-    std::string description;
+    std::pmr::string fullname;
+    std::pmr::string description;
+    std::pmr::string env_variable;
 
     bool takes_param = false;
     bool was_parsed = false;
+    bool has_default = false;
+    ValueSource source = ValueSource::kNone;
 
     bool is_positional = false;
+    // Already recorded by the parser for its next Reset
+    bool is_touched = false;
 
-    std::optional<int> multivalue_min_count = std::nullopt;
+    std::optional<size_t> multivalue_min_count = std::nullopt;
+    // Set by MultiValue to accept several values in one token, e.g. --ids=1,2,3
+    std::optional<char> delimiter = std::nullopt;
+    // Bound to a caller's variable by StoreValue/StoreValues, so always converted during Parse
+    bool has_external_storage = false;
+
+    // Raw tokens of a deferred parse, converted on first read; they view the caller's command line
+    std::pmr::vector<std::string_view> pending_tokens;
+
+    ParseStatus Defer(std::string_view arg) {
+        if (!multivalue_min_count.has_value()) {
+            pending_tokens.clear();
+        }
+        pending_tokens.push_back(arg);
+        was_parsed = true;
+        return ParseStatus::kParsedSuccessfully;
+    }
+
+    // Tokens that fail to convert stay pending, so the failure is seen again by the next read
+    ParseStatus ConvertPending() {
+        ParseStatus status = ParseStatus::kParsedSuccessfully;
+        size_t converted = 0;
+        for (; converted < pending_tokens.size(); ++converted) {
+            status = ParseAndSave(pending_tokens[converted]);
+            if (status != ParseStatus::kParsedSuccessfully) {
+                break;
+            }
+        }
+        pending_tokens.erase(pending_tokens.begin(), pending_tokens.begin() + converted);
+        return status;
+    }
+
+    bool Materialize() {
+        return pending_tokens.empty() || ConvertPending() == ParseStatus::kParsedSuccessfully;
+    }
+
+    bool IsRequired() const {
+        return multivalue_min_count.has_value() ? multivalue_min_count.value() > 0 : !has_default;
+    }
 
     virtual ParseStatus ParseAndSave(std::string_view arg) = 0;
+    virtual void Reset() = 0;
     virtual bool Validate() const = 0;
     virtual std::string Info() const = 0;
     virtual std::string_view GetTypename() const = 0;
+
+    virtual ArgSlot* CreateSlot(std::pmr::memory_resource* resource) const = 0;
+    virtual ParseStatus ParseInto(std::string_view arg, ArgSlot& slot) const = 0;
+    virtual bool ValidateSlot(const ArgSlot* slot) const = 0;
 };
 
 template<typename T>
@@ -41,75 +146,112 @@ class Storage {
 public:
     std::optional<T> default_value = std::nullopt;
 
-    ~Storage() {
-        DeleteStorage();
-    }
-
-    Storage() {
-        storage.single = nullptr;
-    }
+    Storage() = default;
+    Storage(const Storage& other) = delete;
+    Storage& operator=(const Storage& other) = delete;
 
-    void Init() {
-        storage.single = new T{};
+    void Save(const T& value) {
+        if (is_multivalue) {
+            multi->push_back(value);
+        }
+        else {
+            *single = value;
+        }
     }
 
-    void Save(const T& value) {
+    void Save(T&& value) {
         if (is_multivalue) {
-            storage.multi->push_back(value);
+            multi->push_back(std::move(value));
         }
         else {
-            *storage.single = value;
+            *single = std::move(value);
         }
     }
 
+    // Not for bool: std::vector<bool> has no element to reference
+    template<typename... Args> requires (!std::is_same_v<T, bool>)
+    T& Emplace(Args&&... args) {
+        if (is_multivalue) {
+            return multi->emplace_back(std::forward<Args>(args)...);
+        }
+        *single = T(std::forward<Args>(args)...);
+        return *single;
+    }
+
     void Multivalue() {
-        DeleteStorage();
         is_multivalue = true;
-        storage.multi = new std::vector<T>;
+    }
+
+    void Reserve(size_t capacity) {
+        multi->reserve(capacity);
+    }
+
+    // Makes room for extra more values, still growing geometrically across repeated calls
+    void Grow(size_t extra) {
+        size_t needed = multi->size() + extra;
+        if (needed > multi->capacity()) {
+            multi->reserve(std::max(needed, multi->capacity() * 2));
+        }
+    }
+
+    void Truncate(size_t size) {
+        multi->erase(multi->begin() + size, multi->end());
     }
 
     void StoreValue(T& external_storage) {
-        external_storage = std::move(*storage.single);
-        DeleteStorage();
-        is_owned = false;
-        storage.single = &external_storage;
+        external_storage = std::move(*single);
+        single = &external_storage;
     }
 
     void StoreValues(std::vector<T>& external_storage) {
-        external_storage = std::move(*storage.multi);
-        DeleteStorage();
-        is_owned = false;
-        storage.multi = &external_storage;
+        external_storage = std::move(*multi);
+        multi = &external_storage;
     }
 
     T& GetValue() {
-        return *storage.single;
+        return *single;
     }
 
     const T& GetValue() const {
-        return *storage.single;
+        return *single;
     }
 
     const std::vector<T>& GetValues() const {
-        return *storage.multi;
+        return *multi;
     }
-private:
-    bool is_multivalue = false;
-    bool is_owned = true;
-    union Pointer { T* single; std::vector<T>* multi; } storage;
 
-    void DeleteStorage() {
-        if (is_owned) {
-            if (is_multivalue) {
-                delete storage.multi;
-            }
-            else {
-                delete storage.single;
-            }
+    std::vector<T> TakeValues() {
+        std::vector<T> taken = std::move(*multi);
+        multi->clear();
+        return taken;
+    }
+
+    // Keeps the capacity of the multi-value vector for the next parse
+    void Reset() {
+        if (is_multivalue) {
+            multi->clear();
+        }
+        else {
+            *single = default_value.has_value() ? default_value.value() : T{};
         }
     }
+private:
+    bool is_multivalue = false;
+    T value{};
+    std::vector<T> values;
+    T* single = &value;
+    std::vector<T>* multi = &values;
+};
+
+template<typename T>
+class ValueSlot final : public ArgSlot {
+public:
+    Storage<T> storage;
 };
 
+template<typename T>
+class ArgHandle;
+
 template<typename T>
 class Argument : public ArgData {
 public:
@@ -117,12 +259,64 @@ public:
 
     Storage<T> storage;
 
-    virtual ParseStatus ParseAndSave(std::string_view arg) override = 0;
+    Argument(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : ArgData(resource) {
+        value_type = TypeTagOf<T>();
+    }
+
+    virtual ParseStatus ParseAndSave(std::string_view arg) override {
+        ParseStatus status = SaveConverted(arg, storage);
+        was_parsed |= status == ParseStatus::kParsedSuccessfully;
+        return status;
+    }
+
+    virtual void Reset() override {
+        storage.Reset();
+        pending_tokens.clear();
+        was_parsed = false;
+        source = has_default ? ValueSource::kDefault : ValueSource::kNone;
+    }
+
+    // Pure conversion used by both ParseAndSave and ParseInto. Custom arguments that only override
+    // ParseAndSave cannot be parsed into a ParseResult: ParseDetached fails with kUnsupported for them.
+    // ArgParser::AddArgument rejects an argument that overrides neither.
+    virtual ParseStatus Convert(std::string_view, T&) const {
+        return ParseStatus::kUnsupported;
+    }
+
+    virtual ArgSlot* CreateSlot(std::pmr::memory_resource* resource) const override {
+        ValueSlot<T>* slot = std::pmr::polymorphic_allocator<ValueSlot<T>>(resource).template new_object<ValueSlot<T>>();
+        if (multivalue_min_count.has_value()) {
+            slot->storage.Multivalue();
+        } else if (storage.default_value.has_value()) {
+            slot->storage.Save(storage.default_value.value());
+            slot->source = ValueSource::kDefault;
+        }
+        return slot;
+    }
+
+    virtual ParseStatus ParseInto(std::string_view arg, ArgSlot& slot) const override {
+        ParseStatus status = SaveConverted(arg, static_cast<ValueSlot<T>&>(slot).storage);
+        slot.was_parsed |= status == ParseStatus::kParsedSuccessfully;
+        return status;
+    }
+
+    virtual bool ValidateSlot(const ArgSlot* slot) const override {
+        if (multivalue_min_count.has_value()) {
+            size_t count = slot ? static_cast<const ValueSlot<T>*>(slot)->storage.GetValues().size() : 0;
+            return count >= multivalue_min_count.value();
+        }
+        return storage.default_value.has_value() || (slot && slot->was_parsed);
+    }
 
     virtual ~Argument() override { }
 
     virtual std::string_view GetTypename() const override {
+#if defined(__cpp_rtti) || defined(_CPPRTTI)
         return typeid(T).name();
+#else
+        return "value";
+#endif
     }
 
     void Initialize(const std::string& fullname, const std::string& description, bool takes_param, char nickname = ' ') {
@@ -132,16 +326,31 @@ public:
             AddNickname(nickname);
         }
         this->takes_param = takes_param;
-        storage.Init();
     }
 
-    Argument<T>& MultiValue(size_t min_cnt = 0) {
+    // A delimiter also splits each token into several values, e.g. MultiValue(0, ',') takes --ids=1,2,3
+    Argument<T>& MultiValue(size_t min_cnt = 0, std::optional<char> delimiter = std::nullopt) {
         storage.Multivalue();
+        storage.Reserve(min_cnt);
         multivalue_min_count = min_cnt;
+        this->delimiter = delimiter;
+        if (registry) {
+            registry->UpdateRequired(this);
+        }
         return *this;
     }
 
+    Argument<T>& Reserve(size_t capacity) {
+        storage.Reserve(capacity);
+        return *this;
+    }
+
+    // Bare tokens fill positionals in declaration order, skipping one whose type rejects the token.
+    // A multi-value positional is greedy: after its first value, the first token it rejects closes it.
     Argument<T>& Positional() {
+        if (registry && !is_positional) {
+            registry->RegisterPositional(this);
+        }
         is_positional = true;
         return *this;
     }
@@ -150,50 +359,172 @@ public:
         if (!multivalue_min_count.has_value()) {
             storage.Save(standard);
             storage.default_value = standard;
+            has_default = true;
+            source = ValueSource::kDefault;
+            if (registry) {
+                registry->UpdateRequired(this);
+            }
+        }
+        return *this;
+    }
+
+    Argument<T>& Env(std::string_view variable) {
+        env_variable = variable;
+        if (registry) {
+            registry->RegisterEnv(this);
         }
         return *this;
     }
 
     Argument<T>& StoreValue(T& external_storage) {
         storage.StoreValue(external_storage);
+        has_external_storage = true;
         return *this;
     }
 
     Argument<T>& StoreValues(std::vector<T>& external_storage) {
         storage.StoreValues(external_storage);
+        has_external_storage = true;
         return *this;
     }
 
+    ArgHandle<T> Handle() {
+        return ArgHandle<T>(*this);
+    }
+
     Argument<T>& AddNickname(char nickname) {
+        if (registry) {
+            registry->RegisterNickname(this, nickname);
+        }
         this->nickname = nickname;
         return *this;
     }
 
     virtual bool Validate() const override {
-        return CheckNoDefault() || CheckMinCount(); // <fixed>-[prev-version]: return CheckNoDefault() && CheckMinCount();
+        return multivalue_min_count.has_value() ? CheckMinCount() : CheckNoDefault();
     }
 
     virtual std::string Info() const override {
-        std::stringstream info;
+        std::string info;
 
         if (storage.default_value.has_value()) {
-            info << "[default] ";
+            info += "[default] ";
         }
         if (multivalue_min_count.has_value()) {
-            info << "[repeated, min args = " << multivalue_min_count.value() << "] ";
+            info += "[repeated, min args = ";
+            info += std::to_string(multivalue_min_count.value());
+            if (delimiter.has_value()) {
+                info += ", separated by '";
+                info += delimiter.value();
+                info += '\'';
+            }
+            info += "] ";
         }
-        return info.str();
+        return info;
     }
 
 protected:
 
+    // A multi-value token is converted straight into a value emplaced at the end of the vector and dropped
+    // again if the conversion fails. A single value is converted aside first, so a failed token leaves the
+    // previous (or bound) value untouched.
+    ParseStatus SaveConverted(std::string_view arg, Storage<T>& target) const {
+        if (!multivalue_min_count.has_value()) {
+            T value{};
+            ParseStatus status = Convert(arg, value);
+            if (status == ParseStatus::kParsedSuccessfully) {
+                target.Save(std::move(value));
+            }
+            return status;
+        }
+        if (delimiter.has_value()) {
+            return SaveDelimited(arg, target);
+        }
+        size_t size = target.GetValues().size();
+        ParseStatus status = ConvertBack(arg, target);
+        if (status != ParseStatus::kParsedSuccessfully) {
+            target.Truncate(size);
+        }
+        return status;
+    }
+
+    // Appends the converted value; the caller truncates the vector if the conversion fails
+    ParseStatus ConvertBack(std::string_view arg, Storage<T>& target) const {
+        if constexpr (std::is_same_v<T, bool>) {
+            bool value = false;
+            ParseStatus status = Convert(arg, value);
+            target.Save(value);
+            return status;
+        } else {
+            return Convert(arg, target.Emplace());
+        }
+    }
+
+    // Converts every piece of a delimited token; if one fails, none of the token's values are kept
+    ParseStatus SaveDelimited(std::string_view arg, Storage<T>& target) const {
+        size_t size = target.GetValues().size();
+        target.Grow(CountDelimiters(arg, delimiter.value()) + 1);
+        while (true) {
+            size_t end = arg.find(delimiter.value());
+            ParseStatus status = ConvertBack(arg.substr(0, end), target);
+            if (status != ParseStatus::kParsedSuccessfully) {
+                target.Truncate(size);
+                return status;
+            }
+            if (end == std::string_view::npos) {
+                return ParseStatus::kParsedSuccessfully;
+            }
+            arg.remove_prefix(end + 1);
+        }
+    }
+
     bool CheckNoDefault() const {
         return storage.default_value.has_value() || was_parsed;
     }
 
     bool CheckMinCount() const {
-        return !multivalue_min_count.has_value() || storage.GetValues().size() >= multivalue_min_count.value();
+        if (!multivalue_min_count.has_value()) {
+            return true;
+        }
+        size_t count = storage.GetValues().size() + pending_tokens.size();
+        if (delimiter.has_value()) {
+            for (std::string_view token : pending_tokens) {
+                count += CountDelimiters(token, delimiter.value());
+            }
+        }
+        return count >= multivalue_min_count.value();
+    }
+};
+
+// Typed reference to a registered argument: reads go straight to its storage without a name lookup or a cast.
+// Take the handle after StoreValue/StoreValues; it stays valid for the lifetime of the parser.
+template<typename T>
+class ArgHandle {
+public:
+    ArgHandle() = default;
+
+    explicit ArgHandle(Argument<T>& argument)
+        : argument(&argument) {}
+
+    explicit operator bool() const {
+        return argument != nullptr;
     }
+
+    bool WasParsed() const {
+        return argument->was_parsed;
+    }
+
+    // nullptr when a deferred value fails to convert
+    const T* Value() const {
+        return argument->Materialize() ? &argument->storage.GetValue() : nullptr;
+    }
+
+    const std::vector<T>* Values() const {
+        return argument->Materialize() ? &argument->storage.GetValues() : nullptr;
+    }
+
+private:
+    Argument<T>* argument = nullptr;
 };
 
 } // namespace ArgumentData 
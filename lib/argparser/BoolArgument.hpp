@@ -5,6 +5,10 @@ namespace ArgumentParser {
 using namespace ArgumentData;
 
 class BoolArg final : public Argument<bool> {
+public:
+    using Argument<bool>::Argument;
+
+private:
     ParseStatus ParseAndSave(std::string_view arg) override {
 
         if (arg.size()) {
@@ -17,6 +21,23 @@ class BoolArg final : public Argument<bool> {
         return ParseStatus::kParsedSuccessfully;
     }
 
+    ParseStatus ParseInto(std::string_view arg, ArgSlot& slot) const override {
+        if (arg.size()) {
+            return ParseStatus::kNotParsed;
+        }
+
+        Storage<bool>& slot_storage = static_cast<ValueSlot<bool>&>(slot).storage;
+        slot.was_parsed = true;
+        if (multivalue_min_count.has_value()) {
+            slot_storage.Save(true);
+        }
+        else {
+            slot_storage.Save(!slot_storage.GetValue());
+        }
+
+        return ParseStatus::kParsedSuccessfully;
+    }
+
     void Save(bool value) {
         if (multivalue_min_count.has_value()) {
             storage.Save(value);
@@ -0,0 +1,63 @@
+#include "ConfigFile.hpp"
+
+#include <algorithm>
+
+namespace ArgumentParser {
+
+namespace {
+
+std::string_view Trim(std::string_view text) {
+    const std::string_view kSpaces = " \t\r\f\v";
+    size_t begin = text.find_first_not_of(kSpaces);
+    if (begin == std::string_view::npos) {
+        return std::string_view();
+    }
+    return text.substr(begin, text.find_last_not_of(kSpaces) - begin + 1);
+}
+
+} // namespace
+
+bool ConfigFile::Load(const std::string& path) {
+    entries.clear();
+    MappedFile file;
+    if (!file.Open(path)) {
+        return false;
+    }
+    files.push_back(std::move(file));
+
+    std::string_view text = files.back().View();
+    while (!text.empty()) {
+        size_t line_end = text.find('\n');
+        std::string_view line = Trim(text.substr(0, line_end));
+        text.remove_prefix(line_end == std::string_view::npos ? text.size() : line_end + 1);
+
+        if (line.empty() || line.front() == '#' || line.front() == ';' || line.front() == '[') {
+            continue;
+        }
+        size_t equal_sign_pos = line.find('=');
+        if (equal_sign_pos == std::string_view::npos) {
+            continue;
+        }
+
+        std::string_view key = Trim(line.substr(0, equal_sign_pos));
+        std::string_view value = Trim(line.substr(equal_sign_pos + 1));
+        if (value.size() > 1 && (value.front() == '"' || value.front() == '\'') && value.back() == value.front()) {
+            value = value.substr(1, value.size() - 2);
+        }
+        entries.emplace_back(key, value);
+    }
+
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+        return lhs.first < rhs.first;
+    });
+    return true;
+}
+
+std::span<const ConfigFile::Entry> ConfigFile::Find(std::string_view key) const {
+    auto [begin, end] = std::equal_range(entries.begin(), entries.end(), Entry(key, std::string_view()), [](const Entry& lhs, const Entry& rhs) {
+        return lhs.first < rhs.first;
+    });
+    return std::span<const Entry>(begin, end);
+}
+
+} // namespace ArgumentParser
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "MappedFile.hpp"
+
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ArgumentParser {
+
+// "key = value" file indexed in place: keys and values are views into the mapped file. Loading another
+// file keeps the earlier mappings, so views handed out before stay valid until the ConfigFile is destroyed.
+// Blank lines, lines starting with '#' or ';' and [section] headers are skipped,
+// a key may repeat to give several values and a value may be wrapped in quotes.
+class ConfigFile {
+public:
+    using Entry = std::pair<std::string_view, std::string_view>;
+
+    explicit ConfigFile(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : files(resource), entries(resource) {}
+
+    bool Load(const std::string& path);
+
+    std::span<const Entry> Find(std::string_view key) const;
+
+private:
+    std::pmr::vector<MappedFile> files;
+    std::pmr::vector<Entry> entries;
+};
+
+} // namespace ArgumentParser
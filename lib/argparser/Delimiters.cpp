@@ -0,0 +1,71 @@
+#include "Delimiters.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+#include "Simd.hpp"
+
+namespace ArgumentData {
+
+namespace {
+
+#if !defined(ARGPARSER_X86)
+
+size_t CountScalar(std::string_view text, char delimiter) {
+    return std::count(text.begin(), text.end(), delimiter);
+}
+
+#else
+
+size_t CountSse2(std::string_view text, char delimiter) {
+    __m128i pattern = _mm_set1_epi8(delimiter);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= text.size(); i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i));
+        count += std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, pattern))));
+    }
+    return count + std::count(text.begin() + i, text.end(), delimiter);
+}
+
+#endif
+
+#if defined(ARGPARSER_AVX2)
+
+__attribute__((target("avx2,popcnt"))) size_t CountAvx2(std::string_view text, char delimiter) {
+    __m256i pattern = _mm256_set1_epi8(delimiter);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 32 <= text.size(); i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i));
+        count += std::popcount(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, pattern))));
+    }
+    return count + CountSse2(text.substr(i), delimiter);
+}
+
+#endif
+
+using CountFunction = size_t (*)(std::string_view, char);
+
+CountFunction SelectCounter() {
+#if defined(ARGPARSER_AVX2)
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+        return CountAvx2;
+    }
+#endif
+#if defined(ARGPARSER_X86)
+    return CountSse2;
+#else
+    return CountScalar;
+#endif
+}
+
+} // namespace
+
+size_t CountDelimiters(std::string_view text, char delimiter) {
+    static const CountFunction count = SelectCounter();
+    return count(text, delimiter);
+}
+
+} // namespace ArgumentData
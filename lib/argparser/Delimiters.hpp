@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace ArgumentData {
+
+// Number of occurrences of delimiter in text, counted 16 or 32 bytes at a time on x86
+size_t CountDelimiters(std::string_view text, char delimiter);
+
+} // namespace ArgumentData
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "ArgumentData.hpp"
+#include "StaticHash.hpp"
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace ArgumentParser {
+
+using namespace ArgumentData;
+
+// Specialize for an enum to make it usable with EnumArg and StaticParser:
+//     template<> struct EnumTraits<Mode> {
+//         static constexpr std::array<std::pair<std::string_view, Mode>, 2> kChoices = {{{"fast", Mode::kFast}, {"safe", Mode::kSafe}}};
+//     };
+template<typename E>
+struct EnumTraits;
+
+template<typename E>
+concept IsRegisteredEnum = std::is_enum_v<E> && requires { EnumTraits<E>::kChoices; };
+
+// Name table of a registered enum: a perfect hash over the spellings and the "a|b|c" list shown in help
+template<typename E> requires IsRegisteredEnum<E>
+struct EnumTable {
+    static constexpr auto kChoices = EnumTraits<E>::kChoices;
+    static constexpr size_t kCount = kChoices.size();
+
+    static constexpr std::array<std::string_view, kCount> kNames = [] {
+        std::array<std::string_view, kCount> names{};
+        for (size_t i = 0; i < kCount; ++i) {
+            names[i] = kChoices[i].first;
+        }
+        return names;
+    }();
+    static_assert(kCount > 0 && !HasDuplicates(kNames), "enum choices must be non-empty and distinct");
+
+    static constexpr StaticHash<kCount> kIndex{kNames};
+
+    static constexpr size_t kListLength = [] {
+        size_t length = kCount - 1;
+        for (std::string_view name : kNames) {
+            length += name.size();
+        }
+        return length;
+    }();
+
+    static constexpr std::array<char, kListLength> kList = [] {
+        std::array<char, kListLength> list{};
+        size_t position = 0;
+        for (size_t i = 0; i < kCount; ++i) {
+            if (i != 0) {
+                list[position++] = '|';
+            }
+            for (char symbol : kNames[i]) {
+                list[position++] = symbol;
+            }
+        }
+        return list;
+    }();
+
+    static constexpr std::string_view List() {
+        return {kList.data(), kList.size()};
+    }
+};
+
+template<typename E> requires IsRegisteredEnum<E>
+ParseStatus ConvertEnum(std::string_view arg, E& value) {
+    size_t index = EnumTable<E>::kIndex.Find(arg);
+    if (index == EnumTable<E>::kCount) {
+        return ParseStatus::kNotParsed;
+    }
+    value = EnumTable<E>::kChoices[index].second;
+    return ParseStatus::kParsedSuccessfully;
+}
+
+template<typename E> requires IsRegisteredEnum<E>
+class EnumArg final : public Argument<E> {
+public:
+    using Argument<E>::Argument;
+
+    ParseStatus Convert(std::string_view arg, E& value) const override {
+        return ConvertEnum(arg, value);
+    }
+
+    std::string_view GetTypename() const override {
+        return EnumTable<E>::List();
+    }
+};
+
+} // namespace ArgumentParser
@@ -0,0 +1,126 @@
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ArgumentParser {
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data(std::exchange(other.data, nullptr))
+    , size(std::exchange(other.size, 0))
+    , is_mapped(std::exchange(other.is_mapped, false))
+    , buffer(std::move(other.buffer)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+        is_mapped = std::exchange(other.is_mapped, false);
+        buffer = std::move(other.buffer);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+void MappedFile::Close() {
+#if !defined(_WIN32)
+    if (is_mapped) {
+        munmap(data, size);
+    }
+#endif
+    buffer.reset();
+    data = nullptr;
+    size = 0;
+    is_mapped = false;
+}
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+
+#if !defined(_WIN32)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+    if (!S_ISREG(info.st_mode)) {
+        // Pipes, process substitutions and /proc files report no size and cannot be mapped
+        bool is_read = ReadAll(fd);
+        close(fd);
+        return is_read;
+    }
+    if (info.st_size > 0) {
+        void* mapping = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            data = static_cast<char*>(mapping);
+            size = info.st_size;
+            is_mapped = true;
+        }
+    }
+    close(fd);
+    if (is_mapped || info.st_size == 0) {
+        return true;
+    }
+#endif
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    size = file.tellg();
+    buffer = std::make_unique<char[]>(size);
+    file.seekg(0);
+    file.read(buffer.get(), size);
+    data = buffer.get();
+    return static_cast<bool>(file);
+}
+
+#if !defined(_WIN32)
+
+bool MappedFile::ReadAll(int fd) {
+    size_t capacity = 4096;
+    buffer = std::make_unique<char[]>(capacity);
+    while (true) {
+        if (size == capacity) {
+            std::unique_ptr<char[]> grown = std::make_unique<char[]>(capacity * 2);
+            std::copy(buffer.get(), buffer.get() + size, grown.get());
+            buffer = std::move(grown);
+            capacity *= 2;
+        }
+        ssize_t count = read(fd, buffer.get() + size, capacity - size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            Close();
+            return false;
+        }
+        if (count == 0) {
+            break;
+        }
+        size += count;
+    }
+    data = buffer.get();
+    return true;
+}
+
+#endif
+
+} // namespace ArgumentParser
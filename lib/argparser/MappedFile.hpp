@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace ArgumentParser {
+
+// Private copy of a whole file, memory-mapped copy-on-write where the platform allows it: writes through
+// MutableView never reach the file. The data does not move when the object is moved, so views into it
+// survive reallocation of a container of files.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    bool Open(const std::string& path);
+    void Close();
+
+    std::string_view View() const {
+        return std::string_view(data, size);
+    }
+
+    std::span<char> MutableView() {
+        return std::span<char>(data, size);
+    }
+
+private:
+    // Reads a descriptor that cannot be mapped into the owned buffer, up to end of file
+    bool ReadAll(int fd);
+
+    char* data = nullptr;
+    size_t size = 0;
+    bool is_mapped = false;
+    std::unique_ptr<char[]> buffer;
+};
+
+} // namespace ArgumentParser
@@ -0,0 +1,132 @@
+#include "NameIndex.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace ArgumentParser {
+
+namespace {
+
+const uint32_t kMaxDisplacement = 1 << 16;
+// Doublings of the slot table before giving up on a perfect hash
+const uint32_t kMaxGrowth = 8;
+
+} // namespace
+
+void NameIndex::Clear() {
+    keys.clear();
+    slots.clear();
+    displacements.clear();
+    fallback.clear();
+    slot_mask = 0;
+    bucket_mask = 0;
+}
+
+void NameIndex::Build(const std::vector<std::pair<std::string_view, ArgData*>>& names) {
+    Clear();
+    if (names.empty()) {
+        return;
+    }
+
+    std::vector<uint64_t> hashes;
+    hashes.reserve(names.size());
+    size_t keys_size = 0;
+    for (const auto& [name, arg] : names) {
+        hashes.push_back(HashName(name));
+        keys_size += name.size();
+    }
+
+    keys.reserve(keys_size);
+    for (const auto& [name, arg] : names) {
+        keys.append(name);
+    }
+
+    slot_mask = std::bit_ceil(names.size() * 2) - 1;
+    bucket_mask = std::bit_ceil(names.size() / 4 + 1) - 1;
+    for (uint32_t growth = 0; !TryBuild(names, hashes); ++growth) {
+        if (growth == kMaxGrowth) {
+            slots.clear();
+            displacements.clear();
+            fallback.reserve(names.size());
+            for (size_t i = 0, offset = 0; i < names.size(); offset += names[i].first.size(), ++i) {
+                fallback.emplace(std::string_view(keys).substr(offset, names[i].first.size()), names[i].second);
+            }
+            return;
+        }
+        slot_mask = slot_mask * 2 + 1;
+    }
+}
+
+bool NameIndex::TryBuild(const std::vector<std::pair<std::string_view, ArgData*>>& names, const std::vector<uint64_t>& hashes) {
+    std::vector<std::vector<uint32_t>> buckets(bucket_mask + 1);
+    for (uint32_t i = 0; i < names.size(); ++i) {
+        buckets[hashes[i] & bucket_mask].push_back(i);
+    }
+
+    std::vector<uint32_t> order(buckets.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t lhs, uint32_t rhs) {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+    std::vector<uint32_t> offsets(names.size());
+    for (uint32_t i = 0, offset = 0; i < names.size(); ++i) {
+        offsets[i] = offset;
+        offset += names[i].first.size();
+    }
+
+    slots.assign(slot_mask + 1, Slot());
+    displacements.assign(buckets.size(), 0);
+    std::vector<uint64_t> candidate;
+
+    for (uint32_t bucket : order) {
+        if (buckets[bucket].empty()) {
+            break;
+        }
+
+        bool placed = false;
+        for (uint32_t displacement = 0; displacement < kMaxDisplacement && !placed; ++displacement) {
+            candidate.clear();
+            placed = true;
+            for (uint32_t key : buckets[bucket]) {
+                uint64_t slot = MixHash(hashes[key], displacement) & slot_mask;
+                if (slots[slot].arg || std::find(candidate.begin(), candidate.end(), slot) != candidate.end()) {
+                    placed = false;
+                    break;
+                }
+                candidate.push_back(slot);
+            }
+            if (placed) {
+                displacements[bucket] = displacement;
+            }
+        }
+
+        if (!placed) {
+            return false;
+        }
+
+        for (size_t i = 0; i < candidate.size(); ++i) {
+            uint32_t key = buckets[bucket][i];
+            slots[candidate[i]] = Slot{ offsets[key], static_cast<uint32_t>(names[key].first.size()), names[key].second };
+        }
+    }
+
+    return true;
+}
+
+ArgData* NameIndex::Find(std::string_view name) const {
+    if (slots.empty()) {
+        auto iterator = fallback.find(name);
+        return iterator != fallback.end() ? iterator->second : nullptr;
+    }
+    uint64_t hash = HashName(name);
+    const Slot& slot = slots[MixHash(hash, displacements[hash & bucket_mask]) & slot_mask];
+    if (slot.arg && slot.length == name.size() && std::string_view(keys).substr(slot.offset, slot.length) == name) {
+        return slot.arg;
+    }
+    return nullptr;
+}
+
+} // namespace ArgumentParser
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ArgumentData.hpp"
+#include "StaticHash.hpp"
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ArgumentParser {
+
+using namespace ArgumentData;
+
+// Immutable perfect-hash table over long argument names.
+// Every name maps to its own slot, so a lookup is one hash, one displacement
+// load and at most one key comparison. Keys are stored back to back in a single buffer.
+// Names that collide on the full 64-bit hash cannot be separated; they are served from a plain map instead.
+class NameIndex {
+public:
+    explicit NameIndex(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : keys(resource), slots(resource), displacements(resource), fallback(resource) {}
+
+    void Build(const std::vector<std::pair<std::string_view, ArgData*>>& names);
+    void Clear();
+
+    ArgData* Find(std::string_view name) const;
+
+private:
+    struct Slot {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+        ArgData* arg = nullptr;
+    };
+
+    bool TryBuild(const std::vector<std::pair<std::string_view, ArgData*>>& names, const std::vector<uint64_t>& hashes);
+
+    std::pmr::string keys;
+    std::pmr::vector<Slot> slots;
+    std::pmr::vector<uint32_t> displacements;
+    // Used only when no perfect hash was found; the keys view the keys buffer
+    std::pmr::unordered_map<std::string_view, ArgData*> fallback;
+    uint64_t slot_mask = 0;
+    uint64_t bucket_mask = 0;
+};
+
+} // namespace ArgumentParser
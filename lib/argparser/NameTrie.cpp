@@ -0,0 +1,110 @@
+#include "NameTrie.hpp"
+
+#include <algorithm>
+
+namespace ArgumentParser {
+
+void NameTrie::Clear() {
+    nodes.clear();
+}
+
+void NameTrie::Build(const std::vector<std::pair<std::string_view, ArgData*>>& names) {
+    Clear();
+    size_t total_length = 0;
+    for (const auto& [name, arg] : names) {
+        total_length += name.size();
+    }
+    nodes.reserve(total_length + 1);
+    nodes.emplace_back();
+    for (const auto& [name, arg] : names) {
+        uint32_t node = 0;
+        for (char symbol : name) {
+            Node& parent = nodes[node];
+            parent.unique = parent.count++ ? nullptr : arg;
+
+            uint32_t* link = &parent.first_child;
+            while (*link != kNoNode && nodes[*link].label != symbol) {
+                link = &nodes[*link].next_sibling;
+            }
+            if (*link == kNoNode) {
+                *link = static_cast<uint32_t>(nodes.size());
+                nodes.emplace_back().label = symbol;
+            }
+            node = *link;
+        }
+        Node& leaf = nodes[node];
+        leaf.unique = leaf.count++ ? nullptr : arg;
+        leaf.arg = arg;
+    }
+}
+
+uint32_t NameTrie::Walk(std::string_view name) const {
+    if (nodes.empty()) {
+        return kNoNode;
+    }
+    uint32_t node = 0;
+    for (char symbol : name) {
+        node = nodes[node].first_child;
+        while (node != kNoNode && nodes[node].label != symbol) {
+            node = nodes[node].next_sibling;
+        }
+        if (node == kNoNode) {
+            return kNoNode;
+        }
+    }
+    return node;
+}
+
+ArgData* NameTrie::FindPrefix(std::string_view prefix, bool& is_ambiguous) const {
+    is_ambiguous = false;
+    uint32_t node = prefix.empty() ? kNoNode : Walk(prefix);
+    if (node == kNoNode) {
+        return nullptr;
+    }
+    if (nodes[node].arg) {
+        return nodes[node].arg;
+    }
+    is_ambiguous = !nodes[node].unique;
+    return nodes[node].unique;
+}
+
+ArgData* NameTrie::Suggest(std::string_view name, size_t max_distance) const {
+    if (nodes.empty() || name.size() > kMaxSuggestLength) {
+        return nullptr;
+    }
+    Row row;
+    for (size_t i = 0; i <= name.size(); ++i) {
+        row[i] = i;
+    }
+    ArgData* best = nullptr;
+    size_t best_distance = max_distance + 1;
+    for (uint32_t child = nodes[0].first_child; child != kNoNode; child = nodes[child].next_sibling) {
+        Suggest(child, name, row, best, best_distance);
+    }
+    return best;
+}
+
+// One row of the Levenshtein table per trie level: row[i] is the distance between name[0, i) and the path to node
+void NameTrie::Suggest(uint32_t node, std::string_view name, const Row& previous, ArgData*& best, size_t& best_distance) const {
+    Row row;
+    row[0] = previous[0] + 1;
+    size_t row_min = row[0];
+    for (size_t i = 1; i <= name.size(); ++i) {
+        size_t replace = previous[i - 1] + (name[i - 1] == nodes[node].label ? 0 : 1);
+        row[i] = std::min({ previous[i] + 1, row[i - 1] + 1, replace });
+        row_min = std::min(row_min, row[i]);
+    }
+
+    if (nodes[node].arg && row[name.size()] < best_distance) {
+        best = nodes[node].arg;
+        best_distance = row[name.size()];
+    }
+    if (row_min >= best_distance) {
+        return;
+    }
+    for (uint32_t child = nodes[node].first_child; child != kNoNode; child = nodes[child].next_sibling) {
+        Suggest(child, name, row, best, best_distance);
+    }
+}
+
+} // namespace ArgumentParser
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ArgumentData.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ArgumentParser {
+
+using namespace ArgumentData;
+
+// Character trie over long argument names, stored as one flat node array with first-child/next-sibling links.
+// Serves unique-prefix lookups in O(prefix length) and nearest-name suggestions by a bounded edit distance
+// that prunes every subtree whose distance can no longer beat the best match. Neither allocates.
+// Exact lookups go through NameIndex.
+class NameTrie {
+public:
+    static constexpr size_t kMaxSuggestLength = 64;
+
+    explicit NameTrie(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : nodes(resource) {}
+
+    void Build(const std::vector<std::pair<std::string_view, ArgData*>>& names);
+    void Clear();
+
+    // The argument whose name is or uniquely starts with prefix; is_ambiguous tells a shared prefix from a miss
+    ArgData* FindPrefix(std::string_view prefix, bool& is_ambiguous) const;
+    ArgData* Suggest(std::string_view name, size_t max_distance = 2) const;
+
+private:
+    static constexpr uint32_t kNoNode = UINT32_MAX;
+
+    struct Node {
+        char label = 0;
+        uint32_t first_child = kNoNode;
+        uint32_t next_sibling = kNoNode;
+        uint32_t count = 0;
+        ArgData* arg = nullptr;
+        ArgData* unique = nullptr;
+    };
+
+    using Row = std::array<size_t, kMaxSuggestLength + 1>;
+
+    uint32_t Walk(std::string_view name) const;
+    void Suggest(uint32_t node, std::string_view name, const Row& previous, ArgData*& best, size_t& best_distance) const;
+
+    std::pmr::vector<Node> nodes;
+};
+
+} // namespace ArgumentParser
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "ArgumentData.hpp"
+
+#include <charconv>
+#include <concepts>
+#include <limits>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+namespace ArgumentParser {
+
+using namespace ArgumentData;
+
+template<typename T>
+concept IsNumeric = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+// base == 0 detects the radix from a 0x/0X (hex), 0b/0B (binary) or leading 0 (octal) prefix
+template<typename T> requires IsNumeric<T>
+ParseStatus ConvertNumber(std::string_view arg, T& value, int base = 10) {
+    bool is_negative = false;
+    if (!arg.empty() && (arg.front() == '+' || arg.front() == '-')) {
+        is_negative = arg.front() == '-';
+        arg.remove_prefix(1);
+    }
+    if (arg.empty() || arg.front() == '+' || arg.front() == '-') {
+        return ParseStatus::kNotParsed;
+    }
+
+    const char* end = arg.data() + arg.size();
+    std::from_chars_result result;
+
+    if constexpr (std::is_floating_point_v<T>) {
+        result = std::from_chars(arg.data(), end, value);
+        if (is_negative) {
+            value = -value;
+        }
+    } else {
+        if (base == 0) {
+            base = 10;
+            if (arg.size() > 2 && arg[0] == '0' && (arg[1] == 'x' || arg[1] == 'X')) {
+                base = 16;
+                arg.remove_prefix(2);
+            } else if (arg.size() > 2 && arg[0] == '0' && (arg[1] == 'b' || arg[1] == 'B')) {
+                base = 2;
+                arg.remove_prefix(2);
+            } else if (arg.size() > 1 && arg[0] == '0') {
+                base = 8;
+                arg.remove_prefix(1);
+            }
+        }
+
+        using Magnitude = std::make_unsigned_t<T>;
+        Magnitude magnitude = 0;
+        result = std::from_chars(arg.data(), end, magnitude, base);
+        if (result.ec == std::errc() && result.ptr == end) {
+            Magnitude limit = static_cast<Magnitude>(std::numeric_limits<T>::max());
+            if (is_negative) {
+                limit = std::is_signed_v<T> ? limit + 1 : 0;
+            }
+            if (magnitude > limit) {
+                return ParseStatus::kOutOfRange;
+            }
+            value = static_cast<T>(is_negative ? Magnitude(0) - magnitude : magnitude);
+        }
+    }
+
+    if (result.ec == std::errc::result_out_of_range) {
+        return ParseStatus::kOutOfRange;
+    }
+    if (result.ec != std::errc() || result.ptr != end) {
+        return ParseStatus::kNotParsed;
+    }
+    return ParseStatus::kParsedSuccessfully;
+}
+
+template<typename T> requires IsNumeric<T>
+constexpr std::string_view NumericTypename() {
+    if constexpr (std::is_floating_point_v<T>) {
+        return sizeof(T) == sizeof(float) ? "float" : sizeof(T) == sizeof(double) ? "double" : "long double";
+    } else if constexpr (std::is_signed_v<T>) {
+        return sizeof(T) == 1 ? "int8" : sizeof(T) == 2 ? "int16" : sizeof(T) == 4 ? "int" : "int64";
+    } else {
+        return sizeof(T) == 1 ? "uint8" : sizeof(T) == 2 ? "uint16" : sizeof(T) == 4 ? "uint" : "uint64";
+    }
+}
+
+template<typename T> requires IsNumeric<T>
+class NumericArg final : public Argument<T> {
+public:
+    using Argument<T>::Argument;
+
+    ParseStatus Convert(std::string_view arg, T& value) const override {
+        return ConvertNumber(arg, value, base);
+    }
+
+    NumericArg<T>& Base(int base) requires std::integral<T> {
+        this->base = base;
+        return *this;
+    }
+
+    std::string_view GetTypename() const override {
+        return NumericTypename<T>();
+    }
+
+private:
+    int base = 10;
+};
+
+} // namespace ArgumentParser
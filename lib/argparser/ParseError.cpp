@@ -0,0 +1,74 @@
+#include "ParseError.hpp"
+
+namespace ArgumentParser {
+
+namespace {
+
+std::string Quote(std::string_view text) {
+    std::string quoted = "'";
+    quoted += text;
+    quoted += '\'';
+    return quoted;
+}
+
+std::string OptionName(const ArgData* argument) {
+    if (!argument) {
+        return "'?'";
+    }
+    return Quote(argument->is_positional ? "<" + std::string(argument->fullname) + ">" : "--" + std::string(argument->fullname));
+}
+
+} // namespace
+
+std::string ParseError::Message() const {
+    std::string message;
+    switch (code) {
+        case ParseErrorCode::kNone:
+            break;
+        case ParseErrorCode::kInvalidSchema:
+            message = "argument names or nicknames are registered twice";
+            break;
+        case ParseErrorCode::kNotFrozen:
+            message = "parser must be frozen before a detached parse";
+            break;
+        case ParseErrorCode::kUnknownOption:
+            message = "unknown option " + Quote(token);
+            break;
+        case ParseErrorCode::kAmbiguousOption:
+            message = "ambiguous option " + Quote(token);
+            break;
+        case ParseErrorCode::kMissingValue:
+            message = "option " + OptionName(argument) + " requires a value";
+            break;
+        case ParseErrorCode::kInvalidValue:
+            message = "invalid value " + Quote(token) + " for " + OptionName(argument);
+            break;
+        case ParseErrorCode::kOutOfRange:
+            message = "value " + Quote(token) + " is out of range for " + OptionName(argument);
+            break;
+        case ParseErrorCode::kUnexpectedArgument:
+            message = "unexpected argument " + Quote(token);
+            break;
+        case ParseErrorCode::kMissingRequired:
+            message = "missing required " + OptionName(argument);
+            break;
+        case ParseErrorCode::kResponseFile:
+            message = "cannot read response file " + Quote(token);
+            break;
+        case ParseErrorCode::kConfigFile:
+            message = "cannot read config file " + Quote(token);
+            break;
+        case ParseErrorCode::kUnsupported:
+            message = OptionName(argument) + " only overrides ParseAndSave and cannot be parsed detached";
+            break;
+    }
+    if (token_index != kNoToken) {
+        message += " (argument " + std::to_string(token_index) + ")";
+    }
+    if (suggestion) {
+        message += "; did you mean " + OptionName(suggestion) + "?";
+    }
+    return message;
+}
+
+} // namespace ArgumentParser
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ArgumentData.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace ArgumentParser {
+
+using namespace ArgumentData;
+
+enum class ParseErrorCode {
+    kNone,
+    kInvalidSchema,
+    kNotFrozen,
+    kUnknownOption,
+    kAmbiguousOption,
+    kMissingValue,
+    kInvalidValue,
+    kOutOfRange,
+    kUnexpectedArgument,
+    kMissingRequired,
+    kResponseFile,
+    kConfigFile,
+    kUnsupported
+};
+
+// Why a parse failed. Filled only on failure, without allocating: token views the offending command line token
+// (or environment / config value). It is valid while the parsed argv is alive; a token read from a response or
+// config file lives as long as the parser (or the ParseResult of a detached parse). Copy it to keep it longer.
+// argument and suggestion point into the parser and stay valid as long as it does. The text is built only when
+// Message() is called.
+struct ParseError {
+    static constexpr size_t kNoToken = std::numeric_limits<size_t>::max();
+
+    ParseErrorCode code = ParseErrorCode::kNone;
+    size_t token_index = kNoToken;
+    std::string_view token;
+    const ArgData* argument = nullptr;
+    const ArgData* suggestion = nullptr;
+
+    explicit operator bool() const {
+        return code != ParseErrorCode::kNone;
+    }
+
+    std::string Message() const;
+};
+
+} // namespace ArgumentParser
@@ -0,0 +1,80 @@
+#include "ParseResult.hpp"
+
+#include <utility>
+
+namespace ArgumentParser {
+
+ParseResult::ParseResult(const ArgLookup& schema, size_t argument_count)
+    : schema(&schema)
+    , arena(std::make_unique<std::pmr::monotonic_buffer_resource>())
+    , slots(argument_count, nullptr) {}
+
+ParseResult::ParseResult(ParseResult&& other) noexcept
+    : schema(other.schema)
+    , is_ok(other.is_ok)
+    , asked_for_help(other.asked_for_help)
+    , error(std::move(other.error))
+    , arena(std::move(other.arena))
+    , slots(std::move(other.slots))
+    , files(std::move(other.files)) {
+    other.slots.clear();
+}
+
+ParseResult& ParseResult::operator=(ParseResult&& other) noexcept {
+    if (this != &other) {
+        DestroySlots();
+        schema = other.schema;
+        is_ok = other.is_ok;
+        asked_for_help = other.asked_for_help;
+        error = std::move(other.error);
+        arena = std::move(other.arena);
+        slots = std::move(other.slots);
+        files = std::move(other.files);
+        other.slots.clear();
+    }
+    return *this;
+}
+
+ParseResult::~ParseResult() {
+    DestroySlots();
+}
+
+void ParseResult::DestroySlots() {
+    for (ArgSlot* slot : slots) {
+        if (slot) {
+            std::destroy_at(slot);
+        }
+    }
+    slots.clear();
+}
+
+bool ParseResult::WasParsed(std::string_view name) const {
+    const ArgData* arg = schema ? schema->FindArgument(name) : nullptr;
+    const ArgSlot* slot = arg ? GetSlot(arg) : nullptr;
+    return slot && slot->was_parsed;
+}
+
+ValueSource ParseResult::GetSource(std::string_view name) const {
+    const ArgData* arg = schema ? schema->FindArgument(name) : nullptr;
+    if (!arg) {
+        return ValueSource::kNone;
+    }
+    if (const ArgSlot* slot = GetSlot(arg)) {
+        return slot->source;
+    }
+    return arg->has_default ? ValueSource::kDefault : ValueSource::kNone;
+}
+
+const ArgSlot* ParseResult::GetSlot(const ArgData* arg) const {
+    return slots[arg->index];
+}
+
+ArgSlot& ParseResult::GetOrCreateSlot(const ArgData* arg) {
+    ArgSlot*& slot = slots[arg->index];
+    if (!slot) {
+        slot = arg->CreateSlot(arena.get());
+    }
+    return *slot;
+}
+
+} // namespace ArgumentParser
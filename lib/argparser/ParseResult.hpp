@@ -0,0 +1,117 @@
+#pragma once
+
+#include "ArgumentData.hpp"
+#include "MappedFile.hpp"
+#include "ParseError.hpp"
+
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace ArgumentParser {
+
+using namespace ArgumentData;
+
+class ArgLookup {
+public:
+    virtual ~ArgLookup() = default;
+
+    virtual ArgData* FindArgument(std::string_view name) const = 0;
+};
+
+// Values of one ArgParser::ParseDetached call. Slots are created only for arguments the parse touched,
+// in an arena owned by the result; untouched arguments read their Default() from the schema.
+// A result must not outlive the parser that produced it.
+class ParseResult {
+public:
+    ParseResult() = default;
+    ParseResult(const ArgLookup& schema, size_t argument_count);
+    ParseResult(const ParseResult& other) = delete;
+    ParseResult& operator=(const ParseResult& other) = delete;
+    ParseResult(ParseResult&& other) noexcept;
+    ParseResult& operator=(ParseResult&& other) noexcept;
+    ~ParseResult();
+
+    explicit operator bool() const {
+        return is_ok;
+    }
+
+    bool Help() const {
+        return asked_for_help;
+    }
+
+    const ParseError& GetError() const {
+        return error;
+    }
+
+    bool WasParsed(std::string_view name) const;
+    ValueSource GetSource(std::string_view name) const;
+
+    template<typename T>
+    const T* FindValue(std::string_view name) const {
+        const Argument<T>* p_arg = GetArgument<T>(name);
+        if (!p_arg || p_arg->multivalue_min_count.has_value()) {
+            return nullptr;
+        }
+        if (const ArgSlot* slot = slots[p_arg->index]) {
+            return &static_cast<const ValueSlot<T>*>(slot)->storage.GetValue();
+        }
+        return p_arg->storage.default_value.has_value() ? &p_arg->storage.default_value.value() : nullptr;
+    }
+
+    template<typename T>
+    std::optional<T> GetValue(std::string_view name) const {
+        const T* value = FindValue<T>(name);
+        return value ? std::optional<T>(*value) : std::nullopt;
+    }
+
+    template<typename T>
+    std::optional<std::span<const T>> ViewValues(std::string_view name) const {
+        const Argument<T>* p_arg = GetArgument<T>(name);
+        if (!p_arg || !p_arg->multivalue_min_count.has_value()) {
+            return std::nullopt;
+        }
+        if (const ArgSlot* slot = slots[p_arg->index]) {
+            return std::span<const T>(static_cast<const ValueSlot<T>*>(slot)->storage.GetValues());
+        }
+        return std::span<const T>();
+    }
+
+    template<typename T>
+    std::optional<std::vector<T>> GetValues(std::string_view name) const {
+        std::optional<std::span<const T>> values = ViewValues<T>(name);
+        if (!values.has_value()) {
+            return std::nullopt;
+        }
+        return std::vector<T>(values->begin(), values->end());
+    }
+
+private:
+    friend class ArgParser;
+
+    template<typename T>
+    const Argument<T>* GetArgument(std::string_view name) const {
+        const ArgData* p_arg = schema ? schema->FindArgument(name) : nullptr;
+        if (!p_arg || p_arg->value_type != TypeTagOf<T>()) {
+            return nullptr;
+        }
+        return static_cast<const Argument<T>*>(p_arg);
+    }
+
+    const ArgSlot* GetSlot(const ArgData* arg) const;
+    ArgSlot& GetOrCreateSlot(const ArgData* arg);
+    void DestroySlots();
+
+    const ArgLookup* schema = nullptr;
+    bool is_ok = false;
+    bool asked_for_help = false;
+    ParseError error;
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+    std::vector<ArgSlot*> slots;
+    std::pmr::vector<MappedFile> files;
+};
+
+} // namespace ArgumentParser
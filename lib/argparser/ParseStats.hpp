@@ -0,0 +1,119 @@
+#pragma once
+
+#include "TokenClass.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <string_view>
+
+// Instrumentation is compiled in only with -DARGPARSER_STATS (the ARGPARSER_STATS CMake option);
+// otherwise every ARGPARSER_STAT statement expands to nothing and ParseStats stays zero.
+#if defined(ARGPARSER_STATS)
+#define ARGPARSER_STAT(...) __VA_ARGS__
+#else
+#define ARGPARSER_STAT(...)
+#endif
+
+namespace ArgumentParser {
+
+#if defined(ARGPARSER_STATS)
+inline constexpr bool kStatsEnabled = true;
+#else
+inline constexpr bool kStatsEnabled = false;
+#endif
+
+enum class ParsePhase {
+    kRegistration,
+    kParse,
+    kValidation,
+    kHelp
+};
+
+struct ParseStats {
+    std::array<size_t, 5> tokens_by_kind{};
+    size_t lookups = 0;
+    size_t lookup_misses = 0;
+    size_t conversions = 0;
+    size_t failed_conversions = 0;
+    size_t failed_positional_attempts = 0;
+    size_t bytes_allocated = 0;
+    std::array<std::chrono::nanoseconds, 4> phase_time{};
+
+    size_t Tokens(TokenKind kind) const {
+        return tokens_by_kind[static_cast<size_t>(kind)];
+    }
+
+    std::chrono::nanoseconds Time(ParsePhase phase) const {
+        return phase_time[static_cast<size_t>(phase)];
+    }
+};
+
+struct TraceHooks {
+    std::function<void(ParsePhase phase, std::chrono::nanoseconds elapsed)> on_phase;
+    std::function<void(size_t index, std::string_view token, TokenKind kind)> on_token;
+};
+
+// Forwards to upstream and counts the bytes requested through it
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream)
+        : upstream(upstream) {}
+
+    std::pmr::memory_resource* Upstream() const {
+        return upstream;
+    }
+
+    size_t Allocated() const {
+        return allocated;
+    }
+
+    void ResetCount() {
+        allocated = 0;
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocated += bytes;
+        return upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        upstream->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream;
+    size_t allocated = 0;
+};
+
+// Adds the lifetime of the scope to one phase of stats and reports it to the phase hook
+class PhaseTimer {
+public:
+    PhaseTimer(ParseStats& stats, const TraceHooks& hooks, ParsePhase phase)
+        : stats(stats), hooks(hooks), phase(phase), start(std::chrono::steady_clock::now()) {}
+
+    PhaseTimer(const PhaseTimer& other) = delete;
+    PhaseTimer& operator=(const PhaseTimer& other) = delete;
+
+    ~PhaseTimer() {
+        std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+        stats.phase_time[static_cast<size_t>(phase)] += elapsed;
+        if (hooks.on_phase) {
+            hooks.on_phase(phase, elapsed);
+        }
+    }
+
+private:
+    ParseStats& stats;
+    const TraceHooks& hooks;
+    ParsePhase phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+} // namespace ArgumentParser
@@ -0,0 +1,11 @@
+#pragma once
+
+// x86 vector paths: SSE2 is assumed wherever it is the baseline, AVX2 is picked at runtime on GCC and Clang
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ARGPARSER_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(ARGPARSER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define ARGPARSER_AVX2 1
+#endif
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ArgumentParser {
+
+constexpr uint64_t HashName(std::string_view name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char symbol : name) {
+        hash ^= static_cast<unsigned char>(symbol);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+constexpr uint64_t MixHash(uint64_t hash, uint32_t displacement) {
+    uint64_t mixed = hash + displacement * 0x9E3779B97F4A7C15ull;
+    mixed ^= mixed >> 33;
+    mixed *= 0xFF51AFD7ED558CCDull;
+    mixed ^= mixed >> 33;
+    return mixed;
+}
+
+template<size_t N>
+constexpr bool HasDuplicates(const std::array<std::string_view, N>& keys) {
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = i + 1; j < N; ++j) {
+            if (keys[i] == keys[j]) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Compile-time counterpart of NameIndex: a hash-and-displace perfect hash over N distinct keys.
+// Find returns the position of the key in the array given to the constructor, or N.
+template<size_t N>
+class StaticHash {
+public:
+    static constexpr size_t kSlots = std::bit_ceil(N * 2 + 1);
+    static constexpr size_t kBuckets = std::bit_ceil(N / 2 + 1);
+
+    constexpr StaticHash(const std::array<std::string_view, N>& keys)
+        : keys(keys) {
+        slots.fill(N);
+
+        std::array<uint64_t, N> hashes{};
+        std::array<size_t, kBuckets> sizes{};
+        for (size_t i = 0; i < N; ++i) {
+            hashes[i] = HashName(keys[i]);
+            ++sizes[hashes[i] & (kBuckets - 1)];
+        }
+
+        for (size_t size = N; size > 0; --size) {
+            for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+                if (sizes[bucket] == size) {
+                    Place(bucket, hashes);
+                }
+            }
+        }
+    }
+
+    constexpr size_t Find(std::string_view key) const {
+        uint64_t hash = HashName(key);
+        size_t index = slots[MixHash(hash, displacements[hash & (kBuckets - 1)]) & (kSlots - 1)];
+        return index != N && keys[index] == key ? index : N;
+    }
+
+private:
+    constexpr void Place(size_t bucket, const std::array<uint64_t, N>& hashes) {
+        for (uint32_t displacement = 0;; ++displacement) {
+            std::array<size_t, N> candidate{};
+            size_t count = 0;
+            bool placed = true;
+            for (size_t key = 0; key < N && placed; ++key) {
+                if ((hashes[key] & (kBuckets - 1)) != bucket) {
+                    continue;
+                }
+                size_t slot = MixHash(hashes[key], displacement) & (kSlots - 1);
+                placed = slots[slot] == N;
+                for (size_t i = 0; i < count && placed; ++i) {
+                    placed = candidate[i] != slot;
+                }
+                candidate[count++] = slot;
+            }
+            if (placed) {
+                displacements[bucket] = displacement;
+                for (size_t key = 0, i = 0; key < N; ++key) {
+                    if ((hashes[key] & (kBuckets - 1)) == bucket) {
+                        slots[candidate[i++]] = key;
+                    }
+                }
+                return;
+            }
+        }
+    }
+
+    std::array<std::string_view, N> keys;
+    std::array<uint32_t, kBuckets> displacements{};
+    std::array<size_t, kSlots> slots{};
+};
+
+} // namespace ArgumentParser
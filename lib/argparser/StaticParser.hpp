@@ -0,0 +1,282 @@
+#pragma once
+
+#include "ArgumentData.hpp"
+#include "EnumArgument.hpp"
+#include "NumericArgument.hpp"
+#include "StaticHash.hpp"
+#include "TokenSpan.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ArgumentParser {
+
+using namespace ArgumentData;
+
+template<size_t N>
+struct FixedString {
+    char data[N]{};
+
+    constexpr FixedString(const char (&str)[N]) {
+        std::copy_n(str, N, data);
+    }
+
+    constexpr std::string_view View() const {
+        return std::string_view(data, N - 1);
+    }
+};
+
+// Compile-time option descriptor. Nickname '\0' means no short name,
+// bool options are flags and std::vector<T> options collect every occurrence.
+template<FixedString Name, char Nickname, typename T, bool IsPositional = false>
+struct Option {
+    using ValueType = T;
+
+    static constexpr std::string_view kName = Name.View();
+    static constexpr char kNickname = Nickname;
+    static constexpr bool kIsPositional = IsPositional;
+};
+
+template<FixedString Name, typename T>
+using PositionalOption = Option<Name, '\0', T, true>;
+
+template<typename T>
+struct IsVector : std::false_type {};
+
+template<typename T>
+struct IsVector<std::vector<T>> : std::true_type {};
+
+template<typename T> requires IsNumeric<T>
+ParseStatus ConvertValue(std::string_view arg, T& value) {
+    return ConvertNumber(arg, value);
+}
+
+template<typename E> requires IsRegisteredEnum<E>
+ParseStatus ConvertValue(std::string_view arg, E& value) {
+    return ConvertEnum(arg, value);
+}
+
+inline ParseStatus ConvertValue(std::string_view arg, std::string& value) {
+    value.assign(arg);
+    return ParseStatus::kParsedSuccessfully;
+}
+
+inline ParseStatus ConvertValue(std::string_view arg, std::string_view& value) {
+    value = arg;
+    return ParseStatus::kParsedSuccessfully;
+}
+
+template<typename T>
+ParseStatus ConvertValue(std::string_view arg, std::vector<T>& values) {
+    T value{};
+    ParseStatus status = ConvertValue(arg, value);
+    if (status == ParseStatus::kParsedSuccessfully) {
+        values.push_back(std::move(value));
+    }
+    return status;
+}
+
+// Parser specialized for a schema fixed at compile time: names are resolved through a constexpr perfect hash,
+// values live in a tuple member and conversions are direct calls, with no virtual dispatch or heap-allocated arguments.
+template<typename... Options>
+class StaticParser {
+public:
+    static constexpr size_t kCount = sizeof...(Options);
+
+    bool Parse(int argc, char** argv) {
+        return ParseTokens(std::span<const char* const>(argv, argc));
+    }
+
+    bool Parse(std::span<const char* const> argv) {
+        return ParseTokens(argv);
+    }
+
+    bool Parse(const std::vector<std::string>& argv) {
+        return ParseTokens(std::span<const std::string>(argv));
+    }
+
+    bool Parse(const std::vector<std::string_view>& argv) {
+        return ParseTokens(std::span<const std::string_view>(argv));
+    }
+
+    template<FixedString Name>
+    auto& Get() {
+        return std::get<IndexOf<Name>()>(values);
+    }
+
+    template<FixedString Name>
+    const auto& Get() const {
+        return std::get<IndexOf<Name>()>(values);
+    }
+
+    template<FixedString Name>
+    bool WasParsed() const {
+        return parsed[IndexOf<Name>()];
+    }
+
+    static constexpr size_t Find(std::string_view name) {
+        return kIndex.Find(name);
+    }
+
+private:
+    static constexpr std::array<std::string_view, kCount> kNames = { Options::kName... };
+    static constexpr std::array<char, kCount> kNicknames = { Options::kNickname... };
+    static constexpr std::array<bool, kCount> kTakesParam = { !std::is_same_v<typename Options::ValueType, bool>... };
+    static constexpr std::array<bool, kCount> kIsPositional = { Options::kIsPositional... };
+    static constexpr std::array<bool, kCount> kIsMultiValue = { IsVector<typename Options::ValueType>::value... };
+
+    static constexpr bool HasDuplicateNicknames() {
+        for (size_t i = 0; i < kCount; ++i) {
+            for (size_t j = i + 1; j < kCount; ++j) {
+                if (kNicknames[i] != '\0' && kNicknames[i] == kNicknames[j]) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    static_assert(!HasDuplicates(kNames), "StaticParser: two options share a long name");
+    static_assert(!HasDuplicateNicknames(), "StaticParser: two options share a nickname");
+
+    static constexpr StaticHash<kCount> kIndex{ kNames };
+
+    static constexpr std::array<size_t, 256> kShortIndex = [] {
+        std::array<size_t, 256> index{};
+        index.fill(kCount);
+        for (size_t i = 0; i < kCount; ++i) {
+            if (kNicknames[i] != '\0') {
+                index[static_cast<unsigned char>(kNicknames[i])] = i;
+            }
+        }
+        return index;
+    }();
+
+    template<FixedString Name>
+    static constexpr size_t IndexOf() {
+        constexpr size_t index = kIndex.Find(Name.View());
+        static_assert(index != kCount, "StaticParser: no option with this name");
+        return index;
+    }
+
+    template<size_t I>
+    ParseStatus ParseOption(std::string_view arg) {
+        auto& value = std::get<I>(values);
+        ParseStatus status = ParseStatus::kParsedSuccessfully;
+        if constexpr (std::is_same_v<std::remove_reference_t<decltype(value)>, bool>) {
+            value = true;
+        } else {
+            status = ConvertValue(arg, value);
+        }
+        if (status == ParseStatus::kParsedSuccessfully) {
+            parsed[I] = true;
+        }
+        return status;
+    }
+
+    ParseStatus Dispatch(size_t index, std::string_view arg) {
+        return [&]<size_t... I>(std::index_sequence<I...>) {
+            ParseStatus status = ParseStatus::kNotParsed;
+            ((index == I && (status = ParseOption<I>(arg), true)) || ...);
+            return status;
+        }(std::index_sequence_for<Options...>());
+    }
+
+    bool ParseAsPositional(std::string_view arg) {
+        for (; positional_cursor < kCount; ++positional_cursor) {
+            if (kIsPositional[positional_cursor] && (kIsMultiValue[positional_cursor] || !parsed[positional_cursor])) {
+                break;
+            }
+        }
+        return positional_cursor < kCount && Dispatch(positional_cursor, arg) == ParseStatus::kParsedSuccessfully;
+    }
+
+    bool ParseTokens(const TokenSpan& argv) {
+        parsed.reset();
+        positional_cursor = 0;
+        bool met_splitter = false;
+        for (size_t iterator = 1; iterator < argv.size(); ++iterator) {
+            std::string_view token = argv[iterator];
+
+            if (token == "--" && !met_splitter) {
+                met_splitter = true;
+                continue;
+            }
+
+            if (met_splitter || token.size() < 2 || token[0] != '-'
+                || (token[1] != '-' && kShortIndex[static_cast<unsigned char>(token[1])] == kCount)) {
+                if (!ParseAsPositional(token)) {
+                    return false;
+                }
+                continue;
+            }
+
+            if (token[1] == '-') {
+                std::string_view name = token.substr(2);
+                size_t equal_sign_pos = name.find('=');
+                size_t index = kIndex.Find(name.substr(0, equal_sign_pos));
+                if (index == kCount) {
+                    return false;
+                }
+                std::string_view value;
+                if (equal_sign_pos != std::string_view::npos) {
+                    value = name.substr(equal_sign_pos + 1);
+                    if (!kTakesParam[index]) {
+                        return false;
+                    }
+                } else if (kTakesParam[index]) {
+                    if (iterator + 1 >= argv.size()) {
+                        return false;
+                    }
+                    value = argv[++iterator];
+                }
+                if (Dispatch(index, value) != ParseStatus::kParsedSuccessfully) {
+                    return false;
+                }
+                continue;
+            }
+
+            for (size_t i = 1; i < token.size(); ++i) {
+                size_t index = kShortIndex[static_cast<unsigned char>(token[i])];
+                if (index == kCount) {
+                    return false;
+                }
+                if (!kTakesParam[index]) {
+                    Dispatch(index, "");
+                    continue;
+                }
+                std::string_view value;
+                if (i + 1 < token.size()) {
+                    if (token[i + 1] != '=') {
+                        return false;
+                    }
+                    value = token.substr(i + 2);
+                } else if (iterator + 1 < argv.size()) {
+                    value = argv[++iterator];
+                } else {
+                    return false;
+                }
+                if (Dispatch(index, value) != ParseStatus::kParsedSuccessfully) {
+                    return false;
+                }
+                break;
+            }
+        }
+        return true;
+    }
+
+    std::tuple<typename Options::ValueType...> values;
+    std::bitset<kCount> parsed;
+    size_t positional_cursor = 0;
+};
+
+} // namespace ArgumentParser
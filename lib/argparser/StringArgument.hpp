@@ -7,11 +7,12 @@ namespace ArgumentParser {
 using namespace ArgumentData;
 
 class StringArg final : public Argument<std::string> {
-    ParseStatus ParseAndSave(std::string_view arg) override {
-
-        was_parsed = true;
-        storage.Save(std::string(arg));
+public:
+    using Argument<std::string>::Argument;
 
+private:
+    ParseStatus Convert(std::string_view arg, std::string& value) const override {
+        value.assign(arg);
         return ParseStatus::kParsedSuccessfully;
     }
 
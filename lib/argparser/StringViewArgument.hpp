@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string_view>
+
+namespace ArgumentParser {
+
+using namespace ArgumentData;
+
+// Stores views into the tokens passed to Parse instead of copies.
+// The values stay valid only while the argv array, vector or buffer given to Parse is alive and unmodified;
+// parsing std::vector<std::string> temporaries into this argument leaves dangling views.
+class StringViewArg final : public Argument<std::string_view> {
+public:
+    using Argument<std::string_view>::Argument;
+
+private:
+    ParseStatus Convert(std::string_view arg, std::string_view& value) const override {
+        value = arg;
+        return ParseStatus::kParsedSuccessfully;
+    }
+
+    std::string_view GetTypename() const override {
+        return "string";
+    }
+};
+
+} // namespace StringViewArgument
@@ -0,0 +1,129 @@
+#include "TokenClass.hpp"
+
+#include <bit>
+
+#include "Simd.hpp"
+
+namespace ArgumentParser {
+
+namespace {
+
+const char kDash = '-';
+
+TokenInfo LongToken(size_t equal_pos) {
+    if (equal_pos == std::string_view::npos) {
+        return TokenInfo{ TokenKind::kLong, 0 };
+    }
+    return TokenInfo{ TokenKind::kLongWithValue, static_cast<uint32_t>(equal_pos) };
+}
+
+#if !defined(ARGPARSER_X86)
+
+void ClassifyScalar(std::span<const std::string_view> tokens, std::span<TokenInfo> infos) {
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        infos[i] = ClassifyToken(tokens[i]);
+    }
+}
+
+#else
+
+// A token of at least 16 bytes is classified from one load: the '-' mask gives the prefix and the '=' mask of
+// the same bytes usually already holds the separator. Shorter tokens take the scalar path.
+TokenInfo ClassifySse2(std::string_view token) {
+    if (token.size() < 16) {
+        return ClassifyToken(token);
+    }
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(token.data()));
+    uint32_t dashes = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(kDash)));
+    if ((dashes & 3) != 3) {
+        return ClassifyToken(token);
+    }
+
+    uint32_t equals = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('='))) & ~uint32_t(3);
+    size_t i = 16;
+    for (; !equals && i + 16 <= token.size(); i += 16) {
+        bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(token.data() + i));
+        equals = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('=')));
+        if (equals) {
+            return LongToken(i + std::countr_zero(equals));
+        }
+    }
+    return LongToken(equals ? std::countr_zero(equals) : token.find('=', i));
+}
+
+void ClassifySse2(std::span<const std::string_view> tokens, std::span<TokenInfo> infos) {
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        infos[i] = ClassifySse2(tokens[i]);
+    }
+}
+
+#endif
+
+#if defined(ARGPARSER_AVX2)
+
+__attribute__((target("avx2"))) TokenInfo ClassifyAvx2(std::string_view token) {
+    if (token.size() < 32) {
+        return ClassifySse2(token);
+    }
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(token.data()));
+    uint32_t dashes = _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(kDash)));
+    if ((dashes & 3) != 3) {
+        return ClassifyToken(token);
+    }
+
+    uint32_t equals = _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('='))) & ~uint32_t(3);
+    size_t i = 32;
+    for (; !equals && i + 32 <= token.size(); i += 32) {
+        bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(token.data() + i));
+        equals = _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('=')));
+        if (equals) {
+            return LongToken(i + std::countr_zero(equals));
+        }
+    }
+    return LongToken(equals ? std::countr_zero(equals) : token.find('=', i));
+}
+
+__attribute__((target("avx2"))) void ClassifyAvx2(std::span<const std::string_view> tokens, std::span<TokenInfo> infos) {
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        infos[i] = ClassifyAvx2(tokens[i]);
+    }
+}
+
+#endif
+
+using ClassifyFunction = void (*)(std::span<const std::string_view>, std::span<TokenInfo>);
+
+ClassifyFunction SelectClassifier() {
+#if defined(ARGPARSER_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        return ClassifyAvx2;
+    }
+#endif
+#if defined(ARGPARSER_X86)
+    return ClassifySse2;
+#else
+    return ClassifyScalar;
+#endif
+}
+
+} // namespace
+
+TokenInfo ClassifyToken(std::string_view token) {
+    if (token.size() < 2 || token[0] != kDash) {
+        return TokenInfo{};
+    }
+    if (token[1] != kDash) {
+        return TokenInfo{ TokenKind::kShort, 0 };
+    }
+    if (token.size() == 2) {
+        return TokenInfo{ TokenKind::kSplitter, 0 };
+    }
+    return LongToken(token.find('=', 2));
+}
+
+void ClassifyTokens(std::span<const std::string_view> tokens, std::span<TokenInfo> infos) {
+    static const ClassifyFunction classify = SelectClassifier();
+    classify(tokens, infos);
+}
+
+} // namespace ArgumentParser
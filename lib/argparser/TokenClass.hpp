@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace ArgumentParser {
+
+enum class TokenKind : uint8_t {
+    kPositional,
+    kSplitter,
+    kLong,
+    kLongWithValue,
+    kShort
+};
+
+// Shape of one command line token; equal_offset is the position of the first '=' of a kLongWithValue token
+struct TokenInfo {
+    TokenKind kind = TokenKind::kPositional;
+    uint32_t equal_offset = 0;
+};
+
+TokenInfo ClassifyToken(std::string_view token);
+
+// Classifies a block of tokens at once. On x86 the prefix test and the '=' search of a long token share
+// one 16 (SSE2) or 32 (AVX2) byte compare; the instruction set is picked at runtime.
+void ClassifyTokens(std::span<const std::string_view> tokens, std::span<TokenInfo> infos);
+
+} // namespace ArgumentParser
@@ -0,0 +1,178 @@
+#include "TokenCursor.hpp"
+
+#include <algorithm>
+#include <string>
+
+namespace ArgumentParser {
+
+namespace {
+
+bool IsSpace(char symbol) {
+    return symbol == ' ' || symbol == '\t' || symbol == '\n' || symbol == '\r' || symbol == '\f' || symbol == '\v';
+}
+
+} // namespace
+
+TokenCursor::TokenCursor(const TokenSpan& argv, size_t first)
+    : argv(argv), next_index(first) {}
+
+void TokenCursor::ExpandResponseFiles(const ResponseFileOptions& options, std::pmr::vector<MappedFile>& files) {
+    this->options = &options;
+    this->files = &files;
+    is_expanding = true;
+}
+
+void TokenCursor::StopExpansion() {
+    is_expanding = false;
+}
+
+void TokenCursor::ClassifyAhead() {
+    is_classifying = true;
+}
+
+bool TokenCursor::Failed() const {
+    return is_failed;
+}
+
+std::string_view TokenCursor::FailedToken() const {
+    return failed_token;
+}
+
+size_t TokenCursor::Index() const {
+    return next_index - 1;
+}
+
+bool TokenCursor::Next(std::string_view& token) {
+    return Read(token, true);
+}
+
+bool TokenCursor::NextValue(std::string_view& token) {
+    return Read(token, false);
+}
+
+bool TokenCursor::Read(std::string_view& token, bool is_expandable) {
+    while (!is_failed) {
+        if (!sources.empty()) {
+            if (!NextFileToken(sources.back(), token)) {
+                if (!is_failed) {
+                    sources.pop_back();
+                }
+                continue;
+            }
+        } else if (next_index < argv.size()) {
+            token = NextArgvToken();
+        } else {
+            return false;
+        }
+
+        if (is_expandable && is_expanding && token.size() > 1 && token.front() == '@') {
+            if (!OpenResponseFile(token)) {
+                is_failed = true;
+                failed_token = token;
+            }
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool TokenCursor::Next(std::string_view& token, TokenInfo& info) {
+    if (!Next(token)) {
+        return false;
+    }
+    bool is_classified = is_classifying && sources.empty();
+    info = is_classified ? window_infos[next_index - 1 - window_begin] : ClassifyToken(token);
+    return true;
+}
+
+std::string_view TokenCursor::NextArgvToken() {
+    if (!is_classifying) {
+        return argv[next_index++];
+    }
+    if (next_index >= window_begin + window_size) {
+        FillWindow();
+    }
+    return window_tokens[next_index++ - window_begin];
+}
+
+void TokenCursor::FillWindow() {
+    window_begin = next_index;
+    window_size = std::min(kWindowSize, argv.size() - next_index);
+    for (size_t i = 0; i < window_size; ++i) {
+        window_tokens[i] = argv[window_begin + i];
+    }
+    ClassifyTokens(std::span(window_tokens.data(), window_size), std::span(window_infos.data(), window_size));
+}
+
+bool TokenCursor::OpenResponseFile(std::string_view name) {
+    if (sources.size() >= options->max_depth || opened_files >= options->max_files) {
+        return false;
+    }
+    MappedFile file;
+    if (!file.Open(std::string(name.substr(1)))) {
+        return false;
+    }
+    sources.push_back(Source{ file.MutableView(), name });
+    files->push_back(std::move(file));
+    ++opened_files;
+    return true;
+}
+
+bool TokenCursor::NextFileToken(Source& source, std::string_view& token) {
+    std::span<char>& text = source.text;
+    if (options->format == ResponseFileFormat::kNulDelimited) {
+        if (text.empty()) {
+            return false;
+        }
+        std::string_view rest(text.data(), text.size());
+        size_t end = rest.find('\0');
+        token = rest.substr(0, end);
+        text = text.subspan(end == std::string_view::npos ? text.size() : end + 1);
+        return true;
+    }
+
+    size_t begin = 0;
+    while (begin < text.size() && IsSpace(text[begin])) {
+        ++begin;
+    }
+    if (begin == text.size()) {
+        text = std::span<char>();
+        return false;
+    }
+
+    // Quote characters are dropped by moving the rest of the token left over them; bytes are only
+    // written once a quote has been seen, so unquoted tokens leave the mapping untouched
+    char* out = text.data() + begin;
+    size_t length = 0;
+    char quote = '\0';
+    size_t end = begin;
+    for (; end < text.size(); ++end) {
+        char symbol = text[end];
+        if (quote != '\0') {
+            if (symbol == quote) {
+                quote = '\0';
+                continue;
+            }
+        } else if (symbol == '"' || symbol == '\'') {
+            quote = symbol;
+            continue;
+        } else if (IsSpace(symbol)) {
+            break;
+        }
+        if (out + length != text.data() + end) {
+            out[length] = symbol;
+        }
+        ++length;
+    }
+    if (quote != '\0') {
+        is_failed = true;
+        failed_token = source.name;
+        return false;
+    }
+    token = std::string_view(out, length);
+    text = text.subspan(end);
+    return true;
+}
+
+} // namespace ArgumentParser
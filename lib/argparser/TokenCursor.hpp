@@ -0,0 +1,82 @@
+#pragma once
+
+#include "MappedFile.hpp"
+#include "TokenClass.hpp"
+#include "TokenSpan.hpp"
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace ArgumentParser {
+
+enum class ResponseFileFormat {
+    kWhitespace,
+    kNulDelimited
+};
+
+struct ResponseFileOptions {
+    ResponseFileFormat format = ResponseFileFormat::kWhitespace;
+    size_t max_depth = 8;
+    size_t max_files = 256;
+};
+
+// Walks the command line token by token, expanding @file tokens into the tokens of that file when enabled.
+// Only tokens read with Next are expanded; option values read with NextValue are taken as they are.
+// Response file tokens are views into the mapped file. Quotes may appear anywhere in a token, group
+// whitespace and are removed in place (e.g. --name="a b" gives --name=a b); escapes are not processed and
+// an unterminated quote fails the parse.
+class TokenCursor {
+public:
+    TokenCursor(const TokenSpan& argv, size_t first = 1);
+
+    void ExpandResponseFiles(const ResponseFileOptions& options, std::pmr::vector<MappedFile>& files);
+    void StopExpansion();
+    // Reads argv a window at a time and classifies each window with ClassifyTokens
+    void ClassifyAhead();
+
+    bool Next(std::string_view& token);
+    bool Next(std::string_view& token, TokenInfo& info);
+    bool NextValue(std::string_view& token);
+    bool Failed() const;
+    // The @file token whose file could not be opened or holds an unterminated quote
+    std::string_view FailedToken() const;
+    // argv index of the last token; tokens read from a response file report the index of its @file token
+    size_t Index() const;
+
+private:
+    struct Source {
+        std::span<char> text;
+        std::string_view name;
+    };
+
+    bool Read(std::string_view& token, bool is_expandable);
+    bool NextFileToken(Source& source, std::string_view& token);
+    bool OpenResponseFile(std::string_view name);
+    std::string_view NextArgvToken();
+    void FillWindow();
+
+    static constexpr size_t kWindowSize = 256;
+
+    const TokenSpan& argv;
+    size_t next_index;
+
+    const ResponseFileOptions* options = nullptr;
+    std::pmr::vector<MappedFile>* files = nullptr;
+    std::vector<Source> sources;
+    size_t opened_files = 0;
+    bool is_expanding = false;
+    bool is_failed = false;
+    std::string_view failed_token;
+
+    bool is_classifying = false;
+    size_t window_begin = 0;
+    size_t window_size = 0;
+    std::array<std::string_view, kWindowSize> window_tokens;
+    std::array<TokenInfo, kWindowSize> window_infos;
+};
+
+} // namespace ArgumentParser
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace ArgumentParser {
+
+// Non-owning view over command line tokens.
+// argv-style arrays are not measured up front: each token is turned into a string_view only when it is read.
+class TokenSpan {
+public:
+    TokenSpan(std::span<const char* const> tokens)
+        : kind(Kind::kCString), data(tokens.data()), count(tokens.size()) {}
+
+    TokenSpan(std::span<const std::string> tokens)
+        : kind(Kind::kString), data(tokens.data()), count(tokens.size()) {}
+
+    TokenSpan(std::span<const std::string_view> tokens)
+        : kind(Kind::kStringView), data(tokens.data()), count(tokens.size()) {}
+
+    size_t size() const {
+        return count;
+    }
+
+    std::string_view operator[](size_t index) const {
+        switch (kind) {
+            case Kind::kCString:
+                return static_cast<const char* const*>(data)[index];
+            case Kind::kString:
+                return static_cast<const std::string*>(data)[index];
+            default:
+                return static_cast<const std::string_view*>(data)[index];
+        }
+    }
+
+private:
+    enum class Kind {
+        kCString,
+        kString,
+        kStringView
+    };
+
+    Kind kind;
+    const void* data;
+    size_t count;
+};
+
+} // namespace ArgumentParser
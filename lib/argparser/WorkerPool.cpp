@@ -0,0 +1,69 @@
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+
+namespace ArgumentParser {
+
+WorkerPool::WorkerPool(size_t threads) {
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&WorkerPool::Work, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        is_stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::Run(size_t helpers, const std::function<void()>& task) {
+    std::lock_guard<std::mutex> batch_lock(batch_mutex);
+    helpers = std::min(helpers, workers.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        pending = helpers;
+        running = helpers;
+    }
+    wake.notify_all();
+    task();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return running == 0; });
+    this->task = nullptr;
+}
+
+size_t WorkerPool::Size() const {
+    return workers.size();
+}
+
+WorkerPool& WorkerPool::Shared() {
+    static WorkerPool pool(std::max<size_t>(std::thread::hardware_concurrency(), 1) - 1);
+    return pool;
+}
+
+void WorkerPool::Work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return is_stopping || pending > 0; });
+        if (is_stopping) {
+            return;
+        }
+        --pending;
+        const std::function<void()>* current = task;
+        lock.unlock();
+        (*current)();
+        lock.lock();
+        if (--running == 0) {
+            done.notify_all();
+        }
+    }
+}
+
+} // namespace ArgumentParser
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ArgumentParser {
+
+// Fixed set of threads started once and reused by every batch. Run lends up to `helpers` of them to a task
+// that the calling thread also runs, and returns when every copy has finished. Batches from different
+// threads take turns; a task must not call Run on the same pool.
+class WorkerPool {
+public:
+    explicit WorkerPool(size_t threads);
+    WorkerPool(const WorkerPool& other) = delete;
+    WorkerPool& operator=(const WorkerPool& other) = delete;
+    ~WorkerPool();
+
+    void Run(size_t helpers, const std::function<void()>& task);
+    size_t Size() const;
+
+    // One thread less than the hardware has, created on first use
+    static WorkerPool& Shared();
+
+private:
+    void Work();
+
+    std::vector<std::thread> workers;
+    std::mutex batch_mutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void()>* task = nullptr;
+    size_t pending = 0;
+    size_t running = 0;
+    bool is_stopping = false;
+};
+
+} // namespace ArgumentParser
@@ -1,6 +1,9 @@
 #include <lib/argparser/ArgParser.hpp>
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
 #include <sstream>
+#include <unistd.h>
 
 
 using namespace ArgumentParser;
@@ -360,3 +363,876 @@ TEST(ExternalInteractionsArgParserTestSuite, CustomArgExternalPushTest) {
     ASSERT_EQ(parser.GetValue<SizedString>("arg").value().value, "world");
 }
 
+
+
+TEST(ArgParserTestSuite, ShortNameClusterTest) {
+    ArgParser parser("My Parser");
+    parser.AddFlag('x', "extract");
+    parser.AddFlag('v', "verbose");
+    parser.AddFlag('z', "gzip");
+    parser.AddStringArgument("file").AddNickname('f');
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -xvzf arc.tar.gz")));
+    ASSERT_TRUE(parser.GetValue<bool>("extract").value_or(false));
+    ASSERT_TRUE(parser.GetValue<bool>("verbose").value_or(false));
+    ASSERT_TRUE(parser.GetValue<bool>("gzip").value_or(false));
+    ASSERT_EQ(parser.GetValue<std::string>("file").value(), "arc.tar.gz");
+}
+
+
+TEST(ArgParserTestSuite, DuplicateNicknameTest) {
+    ArgParser parser("My Parser");
+    parser.AddFlag('f', "flag1");
+    parser.AddFlag('f', "flag2");
+
+    ASSERT_FALSE(parser.Parse(SplitString("app -f")));
+}
+
+
+TEST(ArgParserTestSuite, FreezeLookupTest) {
+    ArgParser parser("My Parser");
+    for (int i = 0; i < 100; ++i) {
+        parser.AddIntArgument("param" + std::to_string(i)).Default(i);
+    }
+    parser.Freeze();
+
+    ASSERT_TRUE(parser.Parse(SplitString("app --param42=7 --param99 8")));
+    ASSERT_EQ(parser.GetValue<int>("param42").value(), 7);
+    ASSERT_EQ(parser.GetValue<int>("param99").value(), 8);
+    ASSERT_EQ(parser.GetValue<int>("param0").value(), 0);
+    ASSERT_FALSE(parser.GetValue<int>("param100").has_value());
+    ASSERT_FALSE(parser.Parse(SplitString("app --param100=1")));
+}
+
+
+TEST(ArgParserTestSuite, NumericTypesTest) {
+    ArgParser parser("My Parser");
+    parser.AddNumericArgument<int8_t>("small");
+    parser.AddNumericArgument<uint64_t>("big");
+    parser.AddNumericArgument<double>("real");
+    parser.AddNumericArgument<int>("mask").Base(0);
+
+    ASSERT_TRUE(parser.Parse(SplitString("app --small=-128 --big=18446744073709551615 --real=2.5e3 --mask=0x1F")));
+    ASSERT_EQ(parser.GetValue<int8_t>("small").value(), -128);
+    ASSERT_EQ(parser.GetValue<uint64_t>("big").value(), 18446744073709551615ull);
+    ASSERT_EQ(parser.GetValue<double>("real").value(), 2500.0);
+    ASSERT_EQ(parser.GetValue<int>("mask").value(), 31);
+}
+
+
+TEST(ArgParserTestSuite, NumericRangeTest) {
+    int8_t small;
+    ASSERT_EQ(ConvertNumber<int8_t>("127", small), ParseStatus::kParsedSuccessfully);
+    ASSERT_EQ(ConvertNumber<int8_t>("128", small), ParseStatus::kOutOfRange);
+    ASSERT_EQ(ConvertNumber<int8_t>("-129", small), ParseStatus::kOutOfRange);
+
+    unsigned int positive;
+    ASSERT_EQ(ConvertNumber<unsigned int>("-1", positive), ParseStatus::kOutOfRange);
+    ASSERT_EQ(ConvertNumber<unsigned int>("12abc", positive), ParseStatus::kNotParsed);
+    ASSERT_EQ(ConvertNumber<unsigned int>("017", positive, 0), ParseStatus::kParsedSuccessfully);
+    ASSERT_EQ(positive, 15);
+
+    float real;
+    ASSERT_EQ(ConvertNumber<float>("1e100", real), ParseStatus::kOutOfRange);
+
+    ArgParser parser("My Parser");
+    parser.AddIntArgument("param");
+    ASSERT_FALSE(parser.Parse(SplitString("app --param=99999999999")));
+}
+
+
+TEST(ArgParserTestSuite, RawArgvTest) {
+    ArgParser parser("My Parser");
+    std::vector<int> values;
+    parser.AddFlag('v', "verbose");
+    parser.AddIntArgument("N").MultiValue(1).Positional().StoreValues(values);
+
+    char app[] = "app", flag[] = "--verbose", first[] = "1", second[] = "2";
+    char* argv[] = { app, flag, first, second, nullptr };
+
+    ASSERT_TRUE(parser.Parse(4, argv));
+    ASSERT_TRUE(parser.GetValue<bool>("verbose").value_or(false));
+    ASSERT_EQ(values.size(), 2);
+    ASSERT_EQ(values[1], 2);
+}
+
+
+TEST(ArgParserTestSuite, StringViewTest) {
+    ArgParser parser("My Parser");
+    std::vector<std::string_view> files;
+    parser.AddStringViewArgument('o', "output");
+    parser.AddStringViewArgument("files").MultiValue(1).Positional().StoreValues(files);
+
+    std::vector<std::string> argv = SplitString("app -o out.txt a.txt b.txt c.txt");
+    ASSERT_TRUE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetValue<std::string_view>("output").value(), "out.txt");
+    ASSERT_EQ(parser.GetValue<std::string_view>("output").value().data(), argv[2].data());
+    ASSERT_EQ(files.size(), 3);
+    ASSERT_EQ(files[2], "c.txt");
+    ASSERT_EQ(files[0].data(), argv[3].data());
+}
+
+
+TEST(ArgParserTestSuite, MemoryResourceTest) {
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        size_t allocated = 0;
+        size_t deallocated = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            allocated += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+            deallocated += bytes;
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    CountingResource resource;
+    {
+        ArgParser parser("My Parser", &resource);
+        parser.AddStringArgument('i', "a-rather-long-input-argument-name", "Description that does not fit into SSO");
+        size_t registered = resource.allocated;
+        ASSERT_GT(registered, 0);
+
+        ASSERT_TRUE(parser.Parse(SplitString("app -i=value")));
+        ASSERT_EQ(parser.GetValue<std::string>("a-rather-long-input-argument-name").value(), "value");
+    }
+    ASSERT_EQ(resource.allocated, resource.deallocated);
+}
+
+
+TEST(ArgParserTestSuite, DuplicateNameTest) {
+    ArgParser parser("My Parser");
+    parser.AddIntArgument("param");
+    parser.AddStringArgument("param");
+
+    ASSERT_FALSE(parser.Parse(SplitString("app --param=1")));
+}
+
+
+TEST(ArgParserTestSuite, ReserveMultiValueTest) {
+    ArgParser parser("My Parser");
+    parser.AddStringArgument("files").MultiValue(1).Reserve(64).Positional();
+
+    ASSERT_TRUE(parser.Parse(SplitString("app a b c")));
+    ASSERT_EQ(parser.GetValues<std::string>("files").value().size(), 3);
+    ASSERT_EQ(parser.GetValues<std::string>("files").value()[1], "b");
+}
+
+
+TEST(ArgParserTestSuite, HandleTest) {
+    ArgParser parser("My Parser");
+    std::vector<int> values;
+    ArgHandle<std::string> name = parser.AddStringArgument('n', "name").Handle();
+    ArgHandle<bool> verbose = parser.AddFlag('v', "verbose").Handle();
+    ArgHandle<int> numbers = parser.AddIntArgument("N").MultiValue(1).Positional().StoreValues(values).Handle();
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -v --name=value 1 2 3")));
+    ASSERT_TRUE(name.WasParsed());
+    ASSERT_EQ(*name.Value(), "value");
+    ASSERT_TRUE(*verbose.Value());
+    ASSERT_EQ(numbers.Values()->size(), 3);
+    ASSERT_EQ(numbers.Values(), &values);
+
+    ASSERT_TRUE(parser.GetHandle<std::string>("name"));
+    ASSERT_FALSE(parser.GetHandle<int>("name"));
+}
+
+
+TEST(ArgParserTestSuite, NonCopyingAccessTest) {
+    ArgParser parser("My Parser");
+    parser.AddStringArgument("input");
+    parser.AddStringArgument("files").MultiValue(1).Positional();
+
+    ASSERT_TRUE(parser.Parse(SplitString("app --input=io.txt a b c")));
+
+    const std::string* input = parser.FindValue<std::string>("input");
+    ASSERT_NE(input, nullptr);
+    ASSERT_EQ(*input, "io.txt");
+    ASSERT_EQ(parser.FindValue<std::string>("files"), nullptr);
+    ASSERT_EQ(parser.FindValue<int>("input"), nullptr);
+
+    std::optional<std::span<const std::string>> files = parser.ViewValues<std::string>("files");
+    ASSERT_TRUE(files.has_value());
+    ASSERT_EQ(files->size(), 3);
+    ASSERT_EQ(files->back(), "c");
+
+    std::vector<std::string> taken = parser.TakeValues<std::string>("files").value();
+    ASSERT_EQ(taken.size(), 3);
+    ASSERT_EQ(taken.front(), "a");
+    ASSERT_TRUE(parser.ViewValues<std::string>("files")->empty());
+}
+
+
+TEST(StaticParserTestSuite, StaticSchemaTest) {
+    StaticParser<
+        Option<"verbose", 'v', bool>,
+        Option<"level", 'l', int>,
+        Option<"output", 'o', std::string>,
+        Option<"define", 'D', std::vector<std::string_view>>,
+        PositionalOption<"files", std::vector<std::string>>
+    > parser;
+
+    std::vector<std::string> argv = SplitString("app -vl=3 --output out.txt -D a --define=b x.txt -- -y.txt");
+    ASSERT_TRUE(parser.Parse(argv));
+    ASSERT_TRUE(parser.Get<"verbose">());
+    ASSERT_EQ(parser.Get<"level">(), 3);
+    ASSERT_EQ(parser.Get<"output">(), "out.txt");
+    ASSERT_EQ(parser.Get<"define">().size(), 2);
+    ASSERT_EQ(parser.Get<"define">()[1], "b");
+    ASSERT_EQ(parser.Get<"files">().size(), 2);
+    ASSERT_EQ(parser.Get<"files">()[1], "-y.txt");
+    ASSERT_TRUE(parser.WasParsed<"output">());
+
+    StaticParser<Option<"level", 'l', int>, PositionalOption<"name", std::string>> reused;
+    argv = SplitString("app first");
+    ASSERT_TRUE(reused.Parse(argv));
+    argv = SplitString("app second");
+    ASSERT_TRUE(reused.Parse(argv));
+    ASSERT_EQ(reused.Get<"name">(), "second");
+    argv = SplitString("app -l 2");
+    ASSERT_TRUE(reused.Parse(argv));
+    ASSERT_TRUE(reused.WasParsed<"level">());
+    ASSERT_FALSE(reused.WasParsed<"name">());
+}
+
+
+TEST(StaticParserTestSuite, StaticLookupTest) {
+    using Parser = StaticParser<Option<"alpha", 'a', bool>, Option<"beta", 'b', int>, Option<"gamma", '\0', double>>;
+    static_assert(Parser::Find("beta") == 1);
+    static_assert(Parser::Find("delta") == Parser::kCount);
+
+    Parser parser;
+    ASSERT_FALSE(parser.Parse(SplitString("app --delta=1")));
+    ASSERT_FALSE(parser.Parse(SplitString("app --beta=x")));
+}
+
+
+TEST(ArgParserTestSuite, ResponseFileTest) {
+    std::string nested_path = ::testing::TempDir() + "argparser_nested.rsp";
+    std::string path = ::testing::TempDir() + "argparser_args.rsp";
+    {
+        std::ofstream nested(nested_path);
+        nested << "c.txt\n'with space.txt'\n";
+        std::ofstream file(path);
+        file << "--level 3 --name=\"x y\"z --mention @bob\n  a.txt \"b c.txt\"\n@" << nested_path << "\n";
+    }
+
+    ArgParser parser("My Parser");
+    std::vector<std::string_view> files;
+    parser.AddIntArgument("level");
+    parser.AddStringArgument("name");
+    parser.AddStringArgument("mention");
+    parser.AddStringViewArgument("files").MultiValue(1).Positional().StoreValues(files);
+    parser.AllowResponseFiles();
+
+    std::vector<std::string> argv = { "app", "@" + path, "d.txt" };
+    ASSERT_TRUE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetValue<int>("level").value(), 3);
+    ASSERT_EQ(parser.GetValue<std::string>("name").value(), "x yz");
+    ASSERT_EQ(parser.GetValue<std::string>("mention").value(), "@bob");
+    std::vector<std::string_view> answer = { "a.txt", "b c.txt", "c.txt", "with space.txt", "d.txt" };
+    ASSERT_EQ(files, answer);
+
+    std::ifstream written(path);
+    std::string content((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>());
+    ASSERT_EQ(content.substr(0, 20), "--level 3 --name=\"x ");
+}
+
+
+TEST(ArgParserTestSuite, ResponseFileLimitsTest) {
+    std::string path = ::testing::TempDir() + "argparser_loop.rsp";
+    std::string nul_path = ::testing::TempDir() + "argparser_nul.rsp";
+    {
+        std::ofstream file(path);
+        file << "x @" << path;
+        std::ofstream nul_file(nul_path, std::ios::binary);
+        nul_file << std::string("a b\0c\0", 6);
+    }
+
+    ArgParser parser("My Parser");
+    parser.AddStringArgument("files").MultiValue().Positional();
+    parser.AllowResponseFiles();
+    ASSERT_FALSE(parser.Parse(std::vector<std::string>{ "app", "@" + path }));
+    std::vector<std::string> missing_argv = { "app", "@" + path + ".missing" };
+    ASSERT_FALSE(parser.Parse(missing_argv));
+    ASSERT_EQ(parser.GetError().code, ParseErrorCode::kResponseFile);
+    ASSERT_EQ(parser.GetError().token, "@" + path + ".missing");
+
+    std::string quote_path = ::testing::TempDir() + "argparser_quote.rsp";
+    {
+        std::ofstream file(quote_path);
+        file << "--name \"unterminated value\n";
+    }
+    parser.AddStringArgument("name").Default("");
+    std::vector<std::string> quote_argv = { "app", "@" + quote_path };
+    ASSERT_FALSE(parser.Parse(quote_argv));
+    ASSERT_EQ(parser.GetError().code, ParseErrorCode::kResponseFile);
+    ASSERT_EQ(parser.GetError().token, "@" + quote_path);
+
+    ArgParser nul_parser("My Parser");
+    nul_parser.AddStringArgument("files").MultiValue().Positional();
+    nul_parser.AllowResponseFiles({ .format = ResponseFileFormat::kNulDelimited });
+    ASSERT_TRUE(nul_parser.Parse(std::vector<std::string>{ "app", "@" + nul_path }));
+    std::vector<std::string> answer = { "a b", "c" };
+    ASSERT_EQ(nul_parser.GetValues<std::string>("files").value(), answer);
+
+    int pipe_fds[2];
+    ASSERT_EQ(pipe(pipe_fds), 0);
+    ASSERT_EQ(write(pipe_fds[1], "a\0b\0", 4), 4);
+    close(pipe_fds[1]);
+    ArgParser pipe_parser("My Parser");
+    pipe_parser.AddStringArgument("files").MultiValue(1).Positional();
+    pipe_parser.AllowResponseFiles({ .format = ResponseFileFormat::kNulDelimited });
+    std::vector<std::string> pipe_argv = { "app", "@/dev/fd/" + std::to_string(pipe_fds[0]) };
+    ASSERT_TRUE(pipe_parser.Parse(pipe_argv));
+    close(pipe_fds[0]);
+    answer = { "a", "b" };
+    ASSERT_EQ(pipe_parser.GetValues<std::string>("files").value(), answer);
+}
+
+
+TEST(ArgParserTestSuite, LayeredSourcesTest) {
+    std::string path = ::testing::TempDir() + "argparser_config.ini";
+    {
+        std::ofstream file(path);
+        file << "# defaults\n[server]\nhost = example.org\nport = 80\nlevel = 1\nverbose = true\ntag = a\ntag = \"b c\"\n";
+    }
+    setenv("ARGPARSER_TEST_PORT", "8080", 1);
+    setenv("ARGPARSER_TEST_LEVEL", "2", 1);
+
+    ArgParser parser("My Parser");
+    parser.AddStringArgument("host");
+    parser.AddIntArgument("port").Env("ARGPARSER_TEST_PORT");
+    parser.AddIntArgument("level").Env("ARGPARSER_TEST_LEVEL");
+    parser.AddStringArgument("user").Default("root");
+    parser.AddFlag("verbose");
+    parser.AddStringArgument("tag").MultiValue();
+    parser.SetConfigFile(path);
+
+    ASSERT_TRUE(parser.Parse(SplitString("app --level=3")));
+    ASSERT_EQ(parser.GetValue<int>("level").value(), 3);
+    ASSERT_EQ(parser.GetSource("level"), ValueSource::kCommandLine);
+    ASSERT_EQ(parser.GetValue<int>("port").value(), 8080);
+    ASSERT_EQ(parser.GetSource("port"), ValueSource::kEnvironment);
+    ASSERT_EQ(parser.GetValue<std::string>("host").value(), "example.org");
+    ASSERT_EQ(parser.GetSource("host"), ValueSource::kConfigFile);
+    ASSERT_TRUE(parser.GetValue<bool>("verbose").value());
+    ASSERT_EQ(parser.GetValues<std::string>("tag").value(), std::vector<std::string>({ "a", "b c" }));
+    ASSERT_EQ(parser.GetValue<std::string>("user").value(), "root");
+    ASSERT_EQ(parser.GetSource("user"), ValueSource::kDefault);
+
+    std::string other_path = ::testing::TempDir() + "argparser_other.ini";
+    {
+        std::ofstream file(other_path);
+        file << "name = other\n";
+    }
+    ArgParser views("My Parser");
+    views.AddStringViewArgument("name");
+    views.SetConfigFile(path + ".missing");
+    std::vector<std::string> argv = SplitString("app --name=cli");
+    ASSERT_TRUE(views.Parse(argv));
+    views.AddStringViewArgument("host");
+    views.SetConfigFile(path);
+    views.Reset();
+    ASSERT_TRUE(views.Parse(std::vector<std::string>{ "app", "--name=x" }));
+    std::string_view host = views.GetValue<std::string_view>("host").value();
+    views.SetConfigFile(other_path);
+    views.Reset();
+    ASSERT_TRUE(views.Parse(std::vector<std::string>{ "app", "--host=y" }));
+    ASSERT_EQ(views.GetValue<std::string_view>("name").value(), "other");
+    ASSERT_EQ(host, "example.org");
+
+    unsetenv("ARGPARSER_TEST_PORT");
+    unsetenv("ARGPARSER_TEST_LEVEL");
+}
+
+
+class SaveOnlyArg final : public Argument<std::string> {
+public:
+    ParseStatus ParseAndSave(std::string_view arg) override {
+        was_parsed = true;
+        storage.Save(std::string(arg));
+        return ParseStatus::kParsedSuccessfully;
+    }
+};
+
+class NoConversionArg final : public Argument<std::string> {};
+
+TEST(ArgParserTestSuite, BatchParseTest) {
+    ArgParser parser("My Parser");
+    parser.AddIntArgument('n', "number").Default(1);
+    parser.AddStringArgument("name");
+    parser.AddIntArgument("values").MultiValue(1).Positional();
+    parser.AddFlag('v', "verbose");
+    parser.AddHelp('h', "help", "Some Description about program");
+    parser.Freeze();
+
+    std::vector<std::vector<std::string>> command_lines;
+    for (int i = 0; i < 64; ++i) {
+        command_lines.push_back(SplitString("app --name=run" + std::to_string(i) + " -n " + std::to_string(i) + " 1 2 3"));
+    }
+    command_lines.push_back(SplitString("app -v --name=x"));
+    command_lines.push_back(SplitString("app -h"));
+
+    std::vector<ParseResult> results = parser.ParseBatch(command_lines, 4);
+    ASSERT_EQ(results.size(), command_lines.size());
+    for (int i = 0; i < 64; ++i) {
+        ASSERT_TRUE(results[i]);
+        ASSERT_EQ(results[i].GetValue<int>("number").value(), i);
+        ASSERT_EQ(results[i].GetValue<std::string>("name").value(), "run" + std::to_string(i));
+        ASSERT_EQ(results[i].GetValues<int>("values").value(), std::vector<int>({ 1, 2, 3 }));
+        ASSERT_FALSE(results[i].GetValue<bool>("verbose").value());
+        ASSERT_EQ(results[i].GetSource("number"), ValueSource::kCommandLine);
+    }
+    ASSERT_FALSE(results[64]);
+    ASSERT_TRUE(results[65]);
+    ASSERT_TRUE(results[65].Help());
+
+    ASSERT_EQ(parser.GetSource("name"), ValueSource::kNone);
+    ASSERT_EQ(parser.GetValue<int>("number").value(), 1);
+
+    WorkerPool pool(3);
+    results = parser.ParseBatch(command_lines, 0, &pool);
+    ASSERT_EQ(results[10].GetValue<int>("number").value(), 10);
+    results = parser.ParseBatch(command_lines, 1, &pool);
+    ASSERT_EQ(results[63].GetValue<std::string>("name").value(), "run63");
+
+    static_assert(OverridesConversion<SaveOnlyArg> && OverridesConversion<StringArg> && OverridesConversion<BoolArg>);
+    static_assert(!OverridesConversion<NoConversionArg>);
+    ArgParser custom("My Parser");
+    custom.AddArgument<SaveOnlyArg>("word", true);
+    custom.Freeze();
+    ParseResult result = custom.ParseDetached(SplitString("app --word=x"));
+    ASSERT_EQ(result.GetError().code, ParseErrorCode::kUnsupported);
+    ASSERT_TRUE(custom.Parse(SplitString("app --word=x")));
+}
+
+
+TEST(ArgParserTestSuite, ResetTest) {
+    ArgParser parser("My Parser");
+    parser.AddIntArgument('n', "number").Default(1);
+    parser.AddStringArgument("name");
+    parser.AddIntArgument("values").MultiValue(1).Positional();
+    parser.AddFlag('v', "verbose");
+
+    ASSERT_TRUE(parser.Parse(SplitString("app --name=first -v -n 5 1 2")));
+    ASSERT_EQ(parser.GetValue<int>("number").value(), 5);
+    ASSERT_EQ(parser.GetValues<int>("values").value(), std::vector<int>({ 1, 2 }));
+
+    parser.Reset();
+    ASSERT_EQ(parser.GetValue<int>("number").value(), 1);
+    ASSERT_EQ(parser.GetSource("number"), ValueSource::kDefault);
+    ASSERT_FALSE(parser.GetValue<bool>("verbose").value());
+    ASSERT_EQ(parser.GetSource("name"), ValueSource::kNone);
+    ASSERT_FALSE(parser.Parse(SplitString("app 3")));
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse(SplitString("app --name=second -v 3")));
+    ASSERT_TRUE(parser.GetValue<bool>("verbose").value());
+    ASSERT_EQ(parser.GetValues<int>("values").value(), std::vector<int>({ 3 }));
+    ASSERT_EQ(parser.GetValue<std::string>("name").value(), "second");
+
+    setenv("ARGPARSER_TEST_RESET", "7", 1);
+    ArgParser fallback("My Parser");
+    fallback.AddIntArgument("level").Default(1).Env("ARGPARSER_TEST_RESET");
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(fallback.Parse(SplitString("app")));
+    }
+    ASSERT_EQ(fallback.GetSource("level"), ValueSource::kEnvironment);
+    fallback.Reset();
+    ASSERT_EQ(fallback.GetValue<int>("level").value(), 1);
+    ASSERT_EQ(fallback.GetSource("level"), ValueSource::kDefault);
+    unsetenv("ARGPARSER_TEST_RESET");
+}
+
+
+TEST(ArgParserTestSuite, PositionalOrderTest) {
+    ArgParser parser("My Parser");
+    parser.AddStringArgument("source").Positional();
+    parser.AddIntArgument("counts").MultiValue(1).Positional();
+    parser.AddStringArgument("destination").Positional();
+
+    ASSERT_TRUE(parser.Parse(SplitString("app from 1 2 3 to")));
+    ASSERT_EQ(parser.GetValue<std::string>("source").value(), "from");
+    ASSERT_EQ(parser.GetValues<int>("counts").value(), std::vector<int>({ 1, 2, 3 }));
+    ASSERT_EQ(parser.GetValue<std::string>("destination").value(), "to");
+
+    parser.Reset();
+    ASSERT_FALSE(parser.Parse(SplitString("app from 1 to 2")));
+
+    ArgParser typed("My Parser");
+    typed.AddIntArgument("number").Positional();
+    typed.AddStringArgument("name").Positional();
+    ASSERT_TRUE(typed.Parse(SplitString("app foo 5")));
+    ASSERT_EQ(typed.GetValue<int>("number").value(), 5);
+    ASSERT_EQ(typed.GetValue<std::string>("name").value(), "foo");
+
+    ArgParser runs("My Parser");
+    runs.AddIntArgument("counts").MultiValue().Positional();
+    runs.AddStringArgument("files").MultiValue().Positional();
+    ASSERT_TRUE(runs.Parse(SplitString("app 1 2 a 3 b")));
+    ASSERT_EQ(runs.GetValues<int>("counts").value(), std::vector<int>({ 1, 2 }));
+    ASSERT_EQ(runs.GetValues<std::string>("files").value(), std::vector<std::string>({ "a", "3", "b" }));
+
+    runs.Reset();
+    ASSERT_TRUE(runs.Parse(SplitString("app a 1 b 2 c")));
+    ASSERT_TRUE(runs.GetValues<int>("counts").value().empty());
+    ASSERT_EQ(runs.GetValues<std::string>("files").value(), std::vector<std::string>({ "a", "1", "b", "2", "c" }));
+}
+
+
+TEST(ArgParserTestSuite, HelpLayoutTest) {
+    ArgParser parser("My Parser");
+    parser.AddHelp('h', "help", "Some Description about program");
+    parser.AddIntArgument('n', "number", "Some number used to pick the amount of work").Default(1);
+    parser.AddFlag("verbose", "Print more");
+    parser.SetHelpWidth(48);
+
+    std::string expected =
+        "My Parser\n"
+        "Some Description about program\n"
+        "\n"
+        "-n,  --number=<int>  Some number used to pick\n"
+        "                     the amount of work\n"
+        "                     [default]\n"
+        "     --verbose       Print more [default]\n"
+        "\n"
+        "-h,  --help          Display this help and exit\n";
+    ASSERT_EQ(parser.HelpDescription(), expected);
+
+    parser.AddStringArgument("name", "Name");
+    ASSERT_NE(parser.HelpDescription().find("--name=<"), std::string::npos);
+    Argument<int>& ids = parser.AddIntArgument("ids", "Ids").MultiValue();
+    ASSERT_EQ(parser.HelpDescription().find("separated by"), std::string::npos);
+    ids.MultiValue(0, ',');
+    ASSERT_NE(parser.HelpDescription().find("separated by ','"), std::string::npos);
+
+    std::string path = ::testing::TempDir() + "argparser_help.txt";
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    ASSERT_TRUE(parser.WriteHelp(file));
+    std::fclose(file);
+    std::ifstream written(path);
+    std::string content((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>());
+    ASSERT_EQ(content, parser.HelpDescription());
+}
+
+
+TEST(ArgParserTestSuite, ParseErrorTest) {
+    ArgParser parser("My Parser");
+    parser.AddIntArgument('n', "number");
+    parser.AddNumericArgument<uint8_t>("byte").Default(0);
+    parser.AddStringArgument("name").Default("x");
+
+    std::vector<std::string> argv = SplitString("app -n 1");
+    ASSERT_TRUE(parser.Parse(argv));
+    ASSERT_FALSE(parser.GetError());
+
+    argv = SplitString("app -n 1 --missing");
+    ASSERT_FALSE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetError().code, ParseErrorCode::kUnknownOption);
+    ASSERT_EQ(parser.GetError().token_index, 3);
+    ASSERT_EQ(parser.GetError().Message(), "unknown option '--missing' (argument 3)");
+
+    argv = SplitString("app --number abc");
+    ASSERT_FALSE(parser.Parse(argv));
+    argv.clear();
+    ASSERT_EQ(parser.GetError().code, ParseErrorCode::kInvalidValue);
+    ASSERT_EQ(parser.GetError().token, "abc");
+    ASSERT_EQ(parser.GetError().token_index, 2);
+    ASSERT_EQ(parser.GetError().argument->fullname, "number");
+
+    argv = SplitString("app -n 1 --byte=300");
+    ASSERT_FALSE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetError().code, ParseErrorCode::kOutOfRange);
+    argv = SplitString("app -n 1 --name");
+    ASSERT_FALSE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetError().code, ParseErrorCode::kMissingValue);
+    argv = SplitString("app -n 1 extra");
+    ASSERT_FALSE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetError().code, ParseErrorCode::kUnexpectedArgument);
+
+    parser.Reset();
+    parser.Freeze();
+    ParseResult result = parser.ParseDetached(SplitString("app --name=y"));
+    ASSERT_FALSE(result);
+    ASSERT_EQ(result.GetError().code, ParseErrorCode::kMissingRequired);
+    ASSERT_EQ(result.GetError().Message(), "missing required '--number'");
+}
+
+
+TEST(ArgParserTestSuite, SubcommandTest) {
+    int built = 0;
+    ArgParser parser("tool");
+    parser.AddFlag('v', "verbose");
+    parser.AddHelp('h', "help", "Some Description about program");
+    parser.AddSubcommand("clone", [&](ArgParser& command) {
+        ++built;
+        command.AddStringArgument("url").Positional();
+        command.AddIntArgument("depth").Default(0);
+    }, "Clone a repository");
+    parser.AddSubcommand("status", [&](ArgParser& command) {
+        ++built;
+        command.AddFlag('s', "short");
+    }, "Show the working tree status");
+
+    ASSERT_TRUE(parser.Parse(SplitString("tool clone --depth=1 -v https://example.org")));
+    ASSERT_EQ(built, 1);
+    ASSERT_EQ(parser.GetSubcommandName(), "clone");
+    ArgParser* clone = parser.GetSubcommand();
+    ASSERT_EQ(clone->GetValue<std::string>("url").value(), "https://example.org");
+    ASSERT_EQ(clone->GetValue<int>("depth").value(), 1);
+    ASSERT_TRUE(parser.GetValue<bool>("verbose").value());
+
+    parser.Reset();
+    ASSERT_EQ(parser.GetSubcommand(), nullptr);
+    ASSERT_FALSE(parser.Parse(SplitString("tool clone")));
+    ASSERT_EQ(parser.GetError().code, ParseErrorCode::kMissingRequired);
+    ASSERT_EQ(built, 1);
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse(SplitString("tool status -h")));
+    ASSERT_TRUE(parser.Help());
+    ASSERT_EQ(built, 2);
+    ASSERT_NE(parser.HelpDescription().find("Clone a repository"), std::string::npos);
+
+    ASSERT_TRUE(parser.Parse(SplitString("tool clone u")));
+    ASSERT_EQ(parser.GetSubcommandName(), "clone");
+    ASSERT_TRUE(parser.Parse(SplitString("tool -v")));
+    ASSERT_EQ(parser.GetSubcommand(), nullptr);
+    ASSERT_TRUE(parser.GetSubcommandName().empty());
+}
+
+
+TEST(ArgParserTestSuite, DeferredConversionTest) {
+    ArgParser parser("My Parser");
+    parser.AddIntArgument('n', "number");
+    parser.AddIntArgument("level").Default(1);
+    parser.AddIntArgument("values").MultiValue(2);
+    parser.AddIntArgument("files").MultiValue().Positional();
+    int threads = 0;
+    parser.AddIntArgument("threads").Default(1).StoreValue(threads);
+    parser.DeferConversion();
+
+    std::vector<std::string> argv = SplitString("app -n 5 --level=abc --values=1 --values=2 --threads=4 7 8");
+    ASSERT_TRUE(parser.Parse(argv));
+    ASSERT_EQ(threads, 4);
+    ASSERT_EQ(parser.GetValue<int>("number").value(), 5);
+    ASSERT_EQ(parser.GetValues<int>("values").value(), std::vector<int>({ 1, 2 }));
+    ASSERT_EQ(parser.GetValues<int>("files").value(), std::vector<int>({ 7, 8 }));
+    ASSERT_FALSE(parser.GetValue<int>("level").has_value());
+    ASSERT_EQ(parser.GetHandle<int>("level").Value(), nullptr);
+
+    ASSERT_FALSE(parser.ValidateAll());
+    ASSERT_EQ(parser.GetError().code, ParseErrorCode::kInvalidValue);
+    ASSERT_EQ(parser.GetError().token, "abc");
+    ASSERT_EQ(parser.GetError().argument->fullname, "level");
+
+    parser.Reset();
+    argv = SplitString("app -n 6 --values=3 --values=4");
+    ASSERT_TRUE(parser.Parse(argv));
+    ASSERT_TRUE(parser.ValidateAll());
+    ASSERT_EQ(*parser.GetHandle<int>("number").Value(), 6);
+    ASSERT_EQ(parser.GetValue<int>("level").value(), 1);
+
+    argv = SplitString("app -n 7 --values=5 --values=6 --threads=x");
+    ASSERT_FALSE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetError().argument->fullname, "threads");
+}
+
+
+TEST(ArgParserTestSuite, PrefixMatchingTest) {
+    ArgParser parser("My Parser");
+    parser.AddFlag("verbose");
+    parser.AddFlag("version");
+    parser.AddIntArgument("number").Default(0);
+    parser.AddStringArgument("output").Default("a.out");
+
+    std::vector<std::string> argv = SplitString("app --num=3");
+    ASSERT_FALSE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetError().code, ParseErrorCode::kUnknownOption);
+
+    parser.AllowPrefixMatching();
+    argv = SplitString("app --num=3 --verb --out x");
+    ASSERT_TRUE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetValue<int>("number").value(), 3);
+    ASSERT_TRUE(parser.GetValue<bool>("verbose").value());
+    ASSERT_EQ(parser.GetValue<std::string>("output").value(), "x");
+
+    argv = SplitString("app --ver");
+    ASSERT_FALSE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetError().code, ParseErrorCode::kAmbiguousOption);
+
+    argv = SplitString("app --verbsoe");
+    ASSERT_FALSE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetError().code, ParseErrorCode::kUnknownOption);
+    ASSERT_EQ(parser.GetError().suggestion->fullname, "verbose");
+    ASSERT_EQ(parser.GetError().Message(), "unknown option '--verbsoe' (argument 1); did you mean '--verbose'?");
+
+    argv = SplitString("app --something");
+    ASSERT_FALSE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetError().suggestion, nullptr);
+}
+
+
+TEST(ArgParserTestSuite, TokenPrepassTest) {
+    std::vector<std::string> samples = {
+        "", "-", "--", "-x", "-abc", "--a", "--name", "--name=value", "--=x", "plain", "a=b", "-n=5",
+        "--" + std::string(40, 'k') + "=" + std::string(10, 'v'),
+        "--" + std::string(70, 'k'),
+        "--" + std::string(33, 'k') + "==",
+        "--" + std::string(20, 'k') + "=v",
+        "-" + std::string(20, 'k'),
+        std::string(20, 'k') + "--=",
+    };
+    std::vector<std::string_view> tokens;
+    for (size_t i = 0; i < 100; ++i) {
+        tokens.push_back(samples[i % samples.size()]);
+    }
+    std::vector<TokenInfo> infos(tokens.size());
+    ClassifyTokens(tokens, infos);
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        TokenInfo expected = ClassifyToken(tokens[i]);
+        ASSERT_EQ(infos[i].kind, expected.kind) << tokens[i];
+        ASSERT_EQ(infos[i].equal_offset, expected.equal_offset) << tokens[i];
+    }
+    ASSERT_EQ(ClassifyToken("--name=value").kind, TokenKind::kLongWithValue);
+    ASSERT_EQ(ClassifyToken("--name=value").equal_offset, 6);
+
+    ArgParser parser("My Parser");
+    parser.AddIntArgument('n', "number");
+    parser.AddStringArgument("name").MultiValue();
+    parser.AddIntArgument("values").MultiValue().Positional();
+    parser.EnableTokenPrepass();
+
+    std::vector<std::string> argv = { "app" };
+    for (int i = 0; i < 1000; ++i) {
+        argv.push_back("--name=x" + std::to_string(i));
+        argv.push_back(std::to_string(i));
+    }
+    argv.push_back("-n");
+    argv.push_back("7");
+    ASSERT_TRUE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetValue<int>("number").value(), 7);
+    ASSERT_EQ(parser.ViewValues<std::string>("name")->size(), 1000);
+    ASSERT_EQ(parser.ViewValues<int>("values")->back(), 999);
+}
+
+
+TEST(ArgParserTestSuite, ParseStatsTest) {
+    if (!kStatsEnabled) {
+        GTEST_SKIP() << "built without ARGPARSER_STATS";
+    }
+
+    ArgParser parser("My Parser");
+    parser.AddIntArgument('n', "number");
+    parser.AddIntArgument("first").Positional();
+    parser.AddStringArgument("second").Positional();
+    parser.AddHelp('h', "help", "Some Description about program");
+
+    size_t hooked_tokens = 0;
+    size_t parse_phases = 0;
+    parser.SetTraceHooks({
+        .on_phase = [&](ParsePhase phase, std::chrono::nanoseconds) { parse_phases += phase == ParsePhase::kParse; },
+        .on_token = [&](size_t, std::string_view, TokenKind) { ++hooked_tokens; },
+    });
+
+    ASSERT_TRUE(parser.Parse(SplitString("app --number=1 -n 2 3 word")));
+    ASSERT_FALSE(parser.Parse(SplitString("app --missing")));
+    parser.HelpDescription();
+
+    ParseStats stats = parser.GetStats();
+    ASSERT_EQ(stats.Tokens(TokenKind::kLongWithValue), 1);
+    ASSERT_EQ(stats.Tokens(TokenKind::kLong), 1);
+    ASSERT_EQ(stats.Tokens(TokenKind::kShort), 1);
+    ASSERT_EQ(stats.Tokens(TokenKind::kPositional), 2);
+    ASSERT_EQ(stats.lookups, 3);
+    ASSERT_EQ(stats.lookup_misses, 1);
+    ASSERT_EQ(stats.conversions, 4);
+    ASSERT_EQ(stats.failed_conversions, 0);
+    ASSERT_GT(stats.bytes_allocated, 0);
+    ASSERT_GT(stats.Time(ParsePhase::kHelp).count(), 0);
+    ASSERT_EQ(hooked_tokens, 5);
+    ASSERT_EQ(parse_phases, 2);
+
+    parser.ResetStats();
+    ASSERT_EQ(parser.GetStats().lookups, 0);
+}
+
+
+enum class Mode { kFast, kSafe, kParanoid };
+
+template<>
+struct ArgumentParser::EnumTraits<Mode> {
+    static constexpr std::array<std::pair<std::string_view, Mode>, 3> kChoices = {{
+        { "fast", Mode::kFast }, { "safe", Mode::kSafe }, { "paranoid", Mode::kParanoid },
+    }};
+};
+
+TEST(ArgParserTestSuite, EnumArgTest) {
+    ArgParser parser("My Parser");
+    parser.AddEnumArgument<Mode>('m', "mode", "Checking mode").Default(Mode::kSafe);
+    parser.AddEnumArgument<Mode>("levels").MultiValue();
+
+    std::vector<std::string> argv = SplitString("app -m paranoid --levels=fast --levels=safe");
+    ASSERT_TRUE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetValue<Mode>("mode").value(), Mode::kParanoid);
+    ASSERT_EQ(parser.GetValues<Mode>("levels").value(), std::vector<Mode>({ Mode::kFast, Mode::kSafe }));
+
+    argv = SplitString("app --mode=quick");
+    ASSERT_FALSE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetError().code, ParseErrorCode::kInvalidValue);
+    ASSERT_EQ(parser.GetError().token, "quick");
+    ASSERT_NE(parser.HelpDescription().find("--mode=<fast|safe|paranoid>"), std::string::npos);
+
+    StaticParser<Option<"mode", 'm', Mode>> static_parser;
+    argv = SplitString("app -m fast");
+    ASSERT_TRUE(static_parser.Parse(argv));
+    ASSERT_EQ(static_parser.Get<"mode">(), Mode::kFast);
+}
+
+
+TEST(ArgParserTestSuite, DelimitedValuesTest) {
+    ArgParser parser("My Parser");
+    parser.AddIntArgument("ids").MultiValue(4, ',');
+    parser.AddStringArgument("tags").MultiValue(0, ':');
+    parser.AddStringArgument("name").MultiValue();
+
+    ASSERT_TRUE(parser.Parse(SplitString("app --ids=1,2,3 --ids 4 --tags=a::b --name=x,y")));
+    ASSERT_EQ(parser.GetValues<int>("ids").value(), std::vector<int>({ 1, 2, 3, 4 }));
+    ASSERT_EQ(parser.GetValues<std::string>("tags").value(), std::vector<std::string>({ "a", "", "b" }));
+    ASSERT_EQ(parser.GetValues<std::string>("name").value(), std::vector<std::string>({ "x,y" }));
+
+    ASSERT_FALSE(parser.Parse(SplitString("app --ids=1,2,x,4")));
+    ASSERT_EQ(parser.GetError().code, ParseErrorCode::kInvalidValue);
+    ASSERT_EQ(parser.GetValues<int>("ids").value(), std::vector<int>({ 1, 2, 3, 4 }));
+
+    parser.Reset();
+    std::string list = "--ids=";
+    for (int i = 0; i < 1000; ++i) {
+        list += std::to_string(i) + ",";
+    }
+    list.pop_back();
+    std::vector<std::string> argv = { "app", list };
+    ASSERT_TRUE(parser.Parse(argv));
+    ASSERT_EQ(parser.ViewValues<int>("ids")->size(), 1000);
+    ASSERT_EQ(parser.ViewValues<int>("ids")->back(), 999);
+    ASSERT_EQ(CountDelimiters(list, ','), 999);
+
+    parser.Freeze();
+    ParseResult result = parser.ParseDetached(SplitString("app --ids=5,6,7,8"));
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result.GetValues<int>("ids").value(), std::vector<int>({ 5, 6, 7, 8 }));
+
+    parser.Reset();
+    parser.DeferConversion();
+    argv = SplitString("app --ids=9,10,11,12");
+    ASSERT_TRUE(parser.Parse(argv));
+    ASSERT_EQ(parser.GetValues<int>("ids").value(), std::vector<int>({ 9, 10, 11, 12 }));
+}